@@ -0,0 +1,210 @@
+#pragma once
+#include <fcntl.h>
+#include <unistd.h>
+#include <filesystem>
+#include <functional>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <deque>
+
+namespace eopt {
+
+namespace detail {
+
+template <typename T>
+void WriteValue(std::ostream & out, const T & value) { out.write(reinterpret_cast<const char *>(&value), sizeof(T)); }
+
+template <typename T>
+bool ReadValue(std::istream & in, T & value) { return bool(in.read(reinterpret_cast<char *>(&value), sizeof(T))); }
+
+inline void WriteVector(std::ostream & out, const std::vector<double> & values)
+{
+    WriteValue(out, static_cast<uint32_t>(values.size()));
+    out.write(reinterpret_cast<const char *>(values.data()), values.size() * sizeof(double));
+}
+
+inline bool ReadVector(std::istream & in, std::vector<double> & values)
+{
+    uint32_t size{0};
+    if (not ReadValue(in, size)) return false;
+    values.resize(size);
+    return bool(in.read(reinterpret_cast<char *>(values.data()), size * sizeof(double)));
+}
+
+// forces the file, or the entries of a directory, to stable storage
+inline bool Sync(const std::string & path, bool directory = false)
+{
+    auto fd = ::open(path.c_str(), directory ? O_RDONLY | O_DIRECTORY : O_RDONLY);
+    if (fd < 0) return false;
+    auto res = ::fsync(fd);
+    ::close(fd);
+    return 0 == res;
+}
+
+} // namespace detail
+
+// every evaluated point goes to an append-only binary log, record layout: u32 dimension, doubles, double cost;
+// only the latest capacity records stay in memory
+class HistoryLog
+{
+public:
+    struct Record
+    {
+        std::vector<double> parameters;
+        double cost{0};
+    };
+
+    // drops anything written after offset, which is where the last checkpoint left the log
+    HistoryLog(const std::string & filename, size_t capacity = 1024, uint64_t offset = 0)
+     : m_filename(filename), m_capacity(capacity)
+    {
+        if (std::filesystem::exists(filename)) std::filesystem::resize_file(filename, offset);
+        else offset = 0;
+        m_size = offset;
+        m_out.open(filename, std::ios::binary | std::ios::app);
+    }
+
+    void Append(const std::vector<double> & parameters, double cost)
+    {
+        detail::WriteVector(m_out, parameters);
+        detail::WriteValue(m_out, cost);
+        m_size += sizeof(uint32_t) + (parameters.size() + 1) * sizeof(double);
+        m_recent.emplace_back(Record{parameters, cost});
+        if (m_recent.size() > m_capacity) m_recent.pop_front();
+    }
+
+    // flushes to stable storage and returns the log size in bytes
+    uint64_t Flush()
+    {
+        m_out.flush();
+        detail::Sync(m_filename);
+        return m_size;
+    }
+
+    const std::deque<Record> & Recent() const { return m_recent; }
+
+    static bool Read(const std::string & filename, const std::function<void(const Record &)> & reader)
+    {
+        std::ifstream in(filename, std::ios::binary);
+        if (not in.is_open()) return false;
+        Record record;
+        while (detail::ReadVector(in, record.parameters) && detail::ReadValue(in, record.cost))
+            reader(record);
+        return true;
+    }
+
+private:
+    std::string m_filename;
+    size_t m_capacity;
+    uint64_t m_size{0};
+    std::ofstream m_out;
+    std::deque<Record> m_recent;
+};
+
+// settings a checkpoint can only be resumed with, anything else would continue a different run
+struct RunIdentity
+{
+    uint64_t dimension{0};
+    uint64_t batchSize{0};
+    uint64_t seed{0};
+    uint64_t maxIteration{0};
+    double initialTemperature{0};
+    double coolingRate{0};
+
+    bool operator== (const RunIdentity & other) const
+    {
+        return dimension == other.dimension && batchSize == other.batchSize && seed == other.seed && maxIteration == other.maxIteration &&
+               initialTemperature == other.initialTemperature && coolingRate == other.coolingRate;
+    }
+    bool operator!= (const RunIdentity & other) const { return not (*this == other); }
+};
+
+// complete simulated annealing state, the random engine is kept in its textual stream form
+struct AnnealingState
+{
+    RunIdentity identity;
+    bool complete{false};//the run reached maxIteration, nothing left to resume
+    uint64_t iteration{0};
+    double temperature{0};
+    double currentCost{0}, bestCost{0};
+    std::vector<double> currentSolution, bestSolution;
+    std::string rng;
+    uint64_t historyOffset{0};//bytes of the history log covered by this state
+
+    template <typename Engine>
+    void SaveEngine(const Engine & engine) { std::ostringstream ss; ss << engine; rng = ss.str(); }
+
+    template <typename Engine>
+    void LoadEngine(Engine & engine) const { std::istringstream ss(rng); ss >> engine; }
+};
+
+// optimizer state in a single file, written and synced to a temporary file first and renamed over the
+// previous checkpoint so a preemption or power loss leaves either the old or the new state, never a partial one
+class Checkpoint
+{
+public:
+    inline static constexpr char MAGIC[] = "EOPTCKP3";
+    explicit Checkpoint(const std::string & dir) : m_dir(dir)
+    {
+        std::filesystem::create_directories(dir);
+    }
+
+    std::string StateFile() const { return (std::filesystem::path(m_dir) / "state.bin").string(); }
+    std::string HistoryFile() const { return (std::filesystem::path(m_dir) / "history.bin").string(); }
+
+    bool Save(const AnnealingState & state) const
+    {
+        auto tmp = StateFile() + ".tmp";
+        {
+            std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+            out.write(MAGIC, sizeof(MAGIC));
+            detail::WriteValue(out, state.identity);
+            detail::WriteValue(out, static_cast<uint8_t>(state.complete));
+            detail::WriteValue(out, state.iteration);
+            detail::WriteValue(out, state.temperature);
+            detail::WriteValue(out, state.currentCost);
+            detail::WriteValue(out, state.bestCost);
+            detail::WriteVector(out, state.currentSolution);
+            detail::WriteVector(out, state.bestSolution);
+            detail::WriteValue(out, static_cast<uint32_t>(state.rng.size()));
+            out.write(state.rng.data(), state.rng.size());
+            detail::WriteValue(out, state.historyOffset);
+            if (not out.flush()) return false;
+        }
+        if (not detail::Sync(tmp)) return false;
+        std::error_code ec;
+        std::filesystem::rename(tmp, StateFile(), ec);
+        return not ec && detail::Sync(m_dir, true);
+    }
+
+    // false if there is no readable checkpoint, throws if it belongs to a run with a different identity
+    bool Load(AnnealingState & state, const RunIdentity & identity) const
+    {
+        std::ifstream in(StateFile(), std::ios::binary);
+        char magic[sizeof(MAGIC)];
+        if (not in.read(magic, sizeof(MAGIC)) || std::memcmp(magic, MAGIC, sizeof(MAGIC))) return false;
+        uint8_t complete{0};
+        if (not (detail::ReadValue(in, state.identity) && detail::ReadValue(in, complete))) return false;
+        if (state.identity != identity)
+            throw std::invalid_argument("checkpoint in " + m_dir + " belongs to a run with different dimension, batch size, seed, iterations or temperature schedule");
+        state.complete = complete;
+        uint32_t rngSize{0};
+        if (not (detail::ReadValue(in, state.iteration) && detail::ReadValue(in, state.temperature) &&
+                 detail::ReadValue(in, state.currentCost) && detail::ReadValue(in, state.bestCost) &&
+                 detail::ReadVector(in, state.currentSolution) && detail::ReadVector(in, state.bestSolution) &&
+                 detail::ReadValue(in, rngSize))) return false;
+        state.rng.resize(rngSize);
+        if (not in.read(state.rng.data(), rngSize)) return false;
+        return detail::ReadValue(in, state.historyOffset);
+    }
+
+private:
+    std::string m_dir;
+};
+
+} // namespace eopt
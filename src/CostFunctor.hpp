@@ -0,0 +1,314 @@
+#pragma once
+#include "generic/math/MathUtility.hpp"
+#include "generic/tools/FileSystem.hpp"
+#include "EvaluationCache.hpp"
+#include "LayoutOverlay.hpp"
+#include "Feasibility.hpp"
+#include "MultiFidelity.hpp"
+#include "Profiler.hpp"
+#include "ResultSink.hpp"
+#include "EDataMgr.h"
+#include "Design.hpp"
+#include <iostream>
+#include <sstream>
+#include <memory>
+
+inline constexpr ecad::EFloat ENVIRONMENT_TEMPERATURE = 25;
+
+inline ecad::EPrismaThermalModelExtractionSettings PrismaSettings(const std::string & workDir, eopt::Fidelity fidelity = eopt::Fidelity::Fine)
+{
+    ecad::EPrismaThermalModelExtractionSettings prismaSettings;
+    prismaSettings.workDir = workDir;
+    if (fidelity == eopt::Fidelity::Coarse) {
+        prismaSettings.meshSettings.iteration = 1e4;
+        prismaSettings.meshSettings.minAlpha = 15;
+        prismaSettings.meshSettings.minLen = 1e-1;
+        prismaSettings.meshSettings.maxLen = 10000;
+    }
+    else {
+        prismaSettings.meshSettings.iteration = 1e5;
+        prismaSettings.meshSettings.minAlpha = 20;
+        prismaSettings.meshSettings.minLen = 1e-2;
+        prismaSettings.meshSettings.maxLen = 5000;
+    }
+    return prismaSettings;
+}
+
+// design version and fixed simulation setup the results depend on, cache files written under another one are rejected
+inline std::string SimulationIdentity()
+{
+    std::ostringstream ss;
+    ss.precision(17);
+    ss << "design v" << DESIGN_SNAPSHOT_VERSION << " ambient " << ENVIRONMENT_TEMPERATURE;
+    for (auto fidelity : {eopt::Fidelity::Coarse, eopt::Fidelity::Fine}) {
+        const auto & mesh = PrismaSettings({}, fidelity).meshSettings;
+        ss << ' ' << eopt::toString(fidelity) << " mesh " << mesh.iteration << ',' << mesh.minAlpha << ',' << mesh.minLen << ',' << mesh.maxLen;
+    }
+    return ss.str();
+}
+
+struct StaticCostFunctor
+{
+    inline static constexpr size_t PARR_NUM = 15;
+    inline static constexpr size_t ACTIVE_PARR_NUM = 12;//placement parameters the cost depends on
+    explicit StaticCostFunctor(ecad::CPtr<ecad::ILayoutView> layout, std::string workDir = generic::fs::CurrentPath())
+     : m_overlay(layout), m_workDir(std::move(workDir))
+    {
+        m_compIdxMap = {
+            {0, "Inst1/M1"}, {1, "Inst2/M1"}, {2, "Inst3/M1"}, {3, "Inst1/M2"}, {4, "Inst2/M2"}, {5, "Inst3/M2"}
+        };
+    }
+
+    bool operator() (const double* const parameters, double* residual) const
+    {
+        if (m_verbose) {
+            std::cout << "test paras: ";
+            for (size_t i = 0; i < ACTIVE_PARR_NUM; ++i) {
+                std::cout << parameters[i] << ", ";
+            }
+        }
+        for (size_t i = 0; i < ACTIVE_PARR_NUM; ++i) {
+            if (parameters[i] < 0 || 1 < parameters[i]) return false;
+        }
+        if (not Feasible(parameters)) return false;
+        eopt::EvaluationProfile profile;
+        eopt::EvaluationCache::Result result;
+        {
+            eopt::ScopedTimer timer(profile.total);
+            auto delta = Delta(parameters);
+            auto key = m_cache ? m_cache->Key(delta, eopt::toString(m_fidelity)) : std::string{};
+            profile.cached = m_cache && m_cache->Lookup(key, result);
+            if (not profile.cached) {
+                ecad::Ptr<ecad::ILayoutView> layout{nullptr};
+                {
+                    eopt::ScopedTimer timer(profile.apply);
+                    layout = m_overlay.Apply(delta);
+                }
+                auto dataDir = m_sink ? m_sink->RawDataDir(m_workDir) : m_workDir;
+                auto prismaSettings = PrismaSettings(dataDir, m_fidelity);
+
+                ecad::EThermalStaticSimulationSetup setup;
+                setup.environmentTemperature = ENVIRONMENT_TEMPERATURE;
+                setup.workDir = prismaSettings.workDir;
+                {
+                    eopt::ScopedTimer timer(profile.simulate);
+                    result = layout->RunThermalSimulation(prismaSettings, setup);
+                }
+                if (m_cache) m_cache->Insert(key, result);
+                if (m_sink) m_sink->Consume(dataDir, std::vector<double>(parameters, parameters + ACTIVE_PARR_NUM), result.first, result.second);
+            }
+        }
+        if (m_profiler) m_profiler->Record(m_workDir, profile);
+        residual[0] = result.second;
+        if (m_verbose) std::cout << "maxT: " << residual[0] << std::endl;
+        return true;
+    }
+
+    void SetCache(std::shared_ptr<eopt::EvaluationCache> cache) { m_cache = std::move(cache); }
+    void SetFidelity(eopt::Fidelity fidelity) { m_fidelity = fidelity; }
+    void SetProfiler(std::shared_ptr<eopt::Profiler> profiler) { m_profiler = std::move(profiler); }
+    void SetVerbose(bool verbose) { m_verbose = verbose; }
+    void SetResultSink(std::shared_ptr<eopt::ResultSink> sink) { m_sink = std::move(sink); }
+    void SetFeasibilityChecker(std::shared_ptr<const eopt::FeasibilityChecker> checker) { m_checker = std::move(checker); }
+
+    bool Feasible(const double * const parameters) const
+    {
+        if (nullptr == m_checker) return true;
+        auto report = m_checker->Check(Delta(parameters));
+        if (not report && m_verbose) std::cout << "infeasible: " << report.detail << std::endl;
+        return bool(report);
+    }
+
+    eopt::DesignDelta Delta(const double * const parameters) const
+    {
+        eopt::DesignDelta delta;
+        for (size_t i = 0; i < 3; ++i)
+            delta.shifts.emplace(m_compIdxMap.at(i), ecad::FVector2D(parameters[i * 2 + 0] * 10300, parameters[i * 2 + 1] * 4350));
+        for (size_t i = 3; i < 6; ++i)
+            delta.shifts.emplace(m_compIdxMap.at(i), ecad::FVector2D(parameters[i * 2 + 0] * 3250, parameters[i * 2 + 1] * 4200));
+        return delta;
+    }
+private:
+    mutable eopt::LayoutOverlay m_overlay;
+    std::shared_ptr<eopt::EvaluationCache> m_cache;
+    std::shared_ptr<eopt::Profiler> m_profiler;
+    std::shared_ptr<eopt::ResultSink> m_sink;
+    std::shared_ptr<const eopt::FeasibilityChecker> m_checker;
+    eopt::Fidelity m_fidelity{eopt::Fidelity::Fine};
+    bool m_verbose{false};
+    std::string m_workDir;
+    std::unordered_map<size_t, std::string> m_compIdxMap;
+};
+
+struct TransientCostFunctor
+{
+    inline static constexpr size_t PARR_NUM = 3;
+    inline static constexpr size_t ACTIVE_PARR_NUM = PARR_NUM;
+    explicit TransientCostFunctor(ecad::CPtr<ecad::ILayoutView> layout, std::string workDir = generic::fs::CurrentPath())
+     : m_overlay(layout), m_workDir(std::move(workDir))
+    {
+        m_compIdxMap = {
+            {0, "Inst1/M1"}, {1, "Inst2/M1"}, {2, "Inst3/M1"}, {3, "Inst1/M2"}, {4, "Inst2/M2"}, {5, "Inst3/M2"}
+        };
+        // m_lyrParaIdxMap = { {"TopCu", 12}, {"Substrate", 13}, {"CuPlate", 14}}
+        m_lyrParaIdxMap = { {"TopCu", 0}, {"Substrate", 1}, {"CuPlate", 2} }; 
+    }
+
+    bool operator() (const double* const parameters, double* residual) const
+    {
+        if (m_verbose) std::cout << "test paras: ";
+        for (size_t i = 0; i < PARR_NUM; ++i) {
+            if (m_verbose) std::cout << parameters[i] << ", ";
+            if (parameters[i] < 0 || 1 < parameters[i]) return false;
+        }
+        if (m_verbose) std::cout << std::endl;
+        if (not Feasible(parameters)) return false;
+
+        eopt::EvaluationProfile profile;
+        eopt::EvaluationCache::Result result;
+        {
+            eopt::ScopedTimer timer(profile.total);
+            auto delta = Delta(parameters);
+            if (m_verbose) {
+                for (const auto & [lyrName, thickness] : delta.thicknesses)
+                    std::cout << "layer " << lyrName << " 's thickness: " << thickness << std::endl;
+            }
+            auto key = m_cache ? m_cache->Key(delta, Tag()) : std::string{};
+            profile.cached = m_cache && m_cache->Lookup(key, result);
+            if (not profile.cached) {
+                ecad::Ptr<ecad::ILayoutView> layout{nullptr};
+                {
+                    eopt::ScopedTimer timer(profile.apply);
+                    layout = m_overlay.Apply(delta);
+                }
+                auto dataDir = m_sink ? m_sink->RawDataDir(m_workDir) : m_workDir;
+                auto prismaSettings = PrismaSettings(dataDir, m_fidelity);
+
+                auto setup = TransientSetup(prismaSettings.workDir);
+                {
+                    eopt::ScopedTimer timer(profile.simulate);
+                    result = layout->RunThermalSimulation(prismaSettings, setup);
+                }
+                if (m_cache) m_cache->Insert(key, result);
+                if (m_sink) m_sink->Consume(dataDir, std::vector<double>(parameters, parameters + PARR_NUM), result.first, result.second);
+            }
+        }
+        if (m_profiler) m_profiler->Record(m_workDir, profile);
+        auto [minT, maxT] = result;
+        residual[0] = maxT - minT;
+        if (m_verbose) std::cout << "minT: " << minT << ", maxT: " << maxT << ", dT: " << maxT - minT << std::endl;
+        return true;
+    }
+
+    void SetCache(std::shared_ptr<eopt::EvaluationCache> cache) { m_cache = std::move(cache); }
+    void SetFidelity(eopt::Fidelity fidelity) { m_fidelity = fidelity; }
+    void SetProfiler(std::shared_ptr<eopt::Profiler> profiler) { m_profiler = std::move(profiler); }
+    void SetVerbose(bool verbose) { m_verbose = verbose; }
+    void SetResultSink(std::shared_ptr<eopt::ResultSink> sink) { m_sink = std::move(sink); }
+    void SetFeasibilityChecker(std::shared_ptr<const eopt::FeasibilityChecker> checker) { m_checker = std::move(checker); }
+
+    bool Feasible(const double * const parameters) const
+    {
+        if (nullptr == m_checker) return true;
+        auto report = m_checker->Check(Delta(parameters));
+        if (not report && m_verbose) std::cout << "infeasible: " << report.detail << std::endl;
+        return bool(report);
+    }
+
+    void SetModelOrderReduction(bool mor) { m_mor = mor; }
+
+    // power follows |sin(pi * t / period)|, the run integrates settleCycles periods to approach the
+    // periodic steady state and reads min/max temperature over the following sampleCycles periods
+    void SetPeriodicExcitation(ecad::EFloat period, size_t settleCycles, size_t sampleCycles = 2)
+    {
+        m_period = period;
+        m_settleCycles = settleCycles;
+        m_sampleCycles = std::max<size_t>(1, sampleCycles);
+        m_excitation = [period](ecad::EFloat t){ return std::abs(std::sin(generic::math::pi * t / period)); };
+    }
+
+    struct SettleCalibration
+    {
+        size_t cycles{0};
+        size_t runs{0};//transient simulations the calibration took
+        double periods{0};//excitation periods those simulations integrated
+        double seconds{0};
+    };
+
+    // halves the settling cycles from the current setting while the sampled ripple stays within relativeTolerance
+    // of the ripple at the current setting, so the result never exceeds it and a failed run keeps the last good value;
+    // run once per sweep on a representative candidate so later evaluations skip an overlong warm-up
+    SettleCalibration CalibrateSettleCycles(const double * const parameters, double relativeTolerance)
+    {
+        SettleCalibration calibration;
+        calibration.cycles = m_settleCycles;
+        auto run = [&](size_t cycles, double & ripple) {
+            SetPeriodicExcitation(m_period, cycles, m_sampleCycles);
+            calibration.runs++;
+            calibration.periods += cycles + m_sampleCycles;
+            return (*this)(parameters, &ripple);
+        };
+        {
+            eopt::ScopedTimer timer(calibration.seconds);
+            double reference{0}, ripple{0};
+            if (run(calibration.cycles, reference)) {
+                for (auto cycles = calibration.cycles / 2; cycles > 0; cycles /= 2) {
+                    if (not run(cycles, ripple) || std::abs(ripple - reference) > relativeTolerance * std::abs(reference)) break;
+                    calibration.cycles = cycles;
+                }
+            }
+        }
+        SetPeriodicExcitation(m_period, calibration.cycles, m_sampleCycles);
+        return calibration;
+    }
+
+    // distinguishes cached results of different transient settings
+    std::string Tag() const
+    {
+        return std::string(eopt::toString(m_fidelity)) + (m_mor ? ",mor" : "") +
+            ",p" + std::to_string(m_period) + "x" + std::to_string(m_settleCycles) + "+" + std::to_string(m_sampleCycles);
+    }
+
+    // the returned setup refers to the excitation owned by this functor
+    ecad::EThermalTransientSimulationSetup TransientSetup(const std::string & workDir) const
+    {
+        ecad::EThermalTransientSimulationSetup setup;
+        setup.workDir = workDir;
+        setup.environmentTemperature = ENVIRONMENT_TEMPERATURE;
+        setup.settings.mor = m_mor;
+        setup.settings.adaptive = true;
+        setup.settings.dumpRawData = m_sink ? m_sink->DumpRawData() : true;
+        setup.settings.duration = m_period * (m_settleCycles + m_sampleCycles);
+        setup.settings.step = m_period / 5;
+        setup.settings.samplingWindow = m_period * m_sampleCycles;
+        setup.settings.minSamplingInterval = 0.0005;
+        setup.settings.absoluteError = m_fidelity == eopt::Fidelity::Coarse ? 5e-1 : 1e-1;
+        setup.settings.relativeError = m_fidelity == eopt::Fidelity::Coarse ? 5e-1 : 1e-1;
+        setup.settings.excitation = &m_excitation;
+        return setup;
+    }
+
+    eopt::DesignDelta Delta(const double * const parameters) const
+    {
+        eopt::DesignDelta delta;
+        for (const auto & [lyrName, index] : m_lyrParaIdxMap)
+            delta.thicknesses.emplace(lyrName, m_overlay.BaseThickness(lyrName) + parameters[index] * 1000);
+        return delta;
+    }
+private:
+    mutable eopt::LayoutOverlay m_overlay;
+    std::shared_ptr<eopt::EvaluationCache> m_cache;
+    std::shared_ptr<eopt::Profiler> m_profiler;
+    std::shared_ptr<eopt::ResultSink> m_sink;
+    std::shared_ptr<const eopt::FeasibilityChecker> m_checker;
+    eopt::Fidelity m_fidelity{eopt::Fidelity::Fine};
+    bool m_verbose{false};
+    bool m_mor{false};
+    std::string m_workDir;
+    std::unordered_map<size_t, std::string> m_compIdxMap;
+    std::unordered_map<std::string, size_t> m_lyrParaIdxMap;
+    ecad::EFloat m_period{0.05};
+    size_t m_settleCycles{18};
+    size_t m_sampleCycles{2};
+    mutable ecad::EThermalTransientExcitation m_excitation = [](ecad::EFloat t){ return std::abs(std::sin(generic::math::pi * t / 0.05)); };
+};
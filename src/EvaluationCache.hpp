@@ -0,0 +1,114 @@
+#pragma once
+#include "LayoutOverlay.hpp"
+#include <shared_mutex>
+#include <filesystem>
+#include <stdexcept>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <atomic>
+#include <cmath>
+#include <mutex>
+
+namespace eopt {
+
+// memoizes simulation results (minT, maxT) of design deltas quantized to a given resolution,
+// optionally backed by an append-only file so reruns skip designs already simulated, the file starts with
+// a header holding the resolutions its keys were quantized with and the identity of the design and simulation
+// setup its results came from, and is rejected if any of them differ
+class EvaluationCache
+{
+public:
+    using Result = std::pair<ecad::EFloat, ecad::EFloat>;
+    explicit EvaluationCache(ecad::EFloat shiftResolution = 1, ecad::EFloat thicknessResolution = 1, std::string filename = {}, std::string identity = {})
+     : m_shiftResolution(shiftResolution), m_thicknessResolution(thicknessResolution), m_filename(std::move(filename)), m_identity(std::move(identity))
+    {
+        if (m_filename.empty()) return;
+        const bool exists = std::filesystem::exists(m_filename) && std::filesystem::file_size(m_filename);
+        std::ifstream in(m_filename);
+        std::string line;
+        if (exists && (not std::getline(in, line) || line != Header()))
+            throw std::invalid_argument("cache file " + m_filename + " was not written with " + Header());
+        while (std::getline(in, line)) {
+            auto pos = line.find('\t');
+            if (pos == std::string::npos) continue;
+            Result result;
+            std::istringstream ss(line.substr(pos + 1));
+            if (ss >> result.first >> result.second)
+                m_results[line.substr(0, pos)] = result;
+        }
+        m_out.open(m_filename, std::ios::app);
+        m_out.precision(17);
+        if (not exists) m_out << Header() << std::endl;
+    }
+
+    std::string Header() const
+    {
+        std::ostringstream ss;
+        ss.precision(17);
+        ss << "#eopt cache v2 shift resolution " << m_shiftResolution << " thickness resolution " << m_thicknessResolution << " setup " << m_identity;
+        return ss.str();
+    }
+
+    // tag separates results of different simulation settings for the same design
+    std::string Key(const DesignDelta & delta, const std::string & tag = {}) const
+    {
+        std::vector<std::string> items;
+        for (const auto & [name, shift] : delta.shifts)
+            items.emplace_back("s:" + name + ":" + std::to_string(Quantize(shift[0], m_shiftResolution)) + "," + std::to_string(Quantize(shift[1], m_shiftResolution)));
+        for (const auto & [name, thickness] : delta.thicknesses)
+            items.emplace_back("t:" + name + ":" + std::to_string(Quantize(thickness, m_thicknessResolution)));
+        std::sort(items.begin(), items.end());
+        auto key = tag.empty() ? std::string{} : tag + ";";
+        for (const auto & item : items) key += item + ";";
+        return key;
+    }
+
+    bool Lookup(const std::string & key, Result & result) const
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        auto iter = m_results.find(key);
+        if (iter == m_results.cend()) {
+            m_misses++;
+            return false;
+        }
+        result = iter->second;
+        m_hits++;
+        return true;
+    }
+
+    void Insert(const std::string & key, const Result & result)
+    {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        if (not m_results.emplace(key, result).second) return;
+        if (m_out.is_open())
+            m_out << key << '\t' << result.first << ' ' << result.second << std::endl;
+    }
+
+    size_t Hits() const { return m_hits; }
+    size_t Misses() const { return m_misses; }
+    size_t Size() const
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        return m_results.size();
+    }
+
+private:
+    static long long Quantize(ecad::EFloat value, ecad::EFloat resolution)
+    {
+        return std::llround(value / resolution);
+    }
+
+private:
+    ecad::EFloat m_shiftResolution;
+    ecad::EFloat m_thicknessResolution;
+    std::string m_filename;
+    std::string m_identity;
+    std::ofstream m_out;
+    mutable std::shared_mutex m_mutex;
+    mutable std::atomic<size_t> m_hits{0};
+    mutable std::atomic<size_t> m_misses{0};
+    std::unordered_map<std::string, Result> m_results;
+};
+
+} // namespace eopt
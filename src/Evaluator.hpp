@@ -0,0 +1,86 @@
+#pragma once
+#include "generic/thread/ThreadPool.hpp"
+#include "generic/tools/Format.hpp"
+#include <filesystem>
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <future>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace eopt {
+
+// one line per failed evaluation so concurrent workers do not interleave, the candidate keeps the max double cost
+inline void ReportEvaluationError(const std::string & workDir, const std::vector<double> & candidate, const std::string & what)
+{
+    std::cout << generic::fmt::Fmt2Str("evaluation in %1% failed: %2%, candidate: %3%\n", workDir, what, generic::fmt::Fmt2Str(candidate, ",")) << std::flush;
+}
+
+// runs functor(candidate, &cost) and reports exceptions instead of letting them escape the worker
+template <typename CostFunctor>
+bool EvaluateCandidate(const CostFunctor & functor, const std::string & workDir, const std::vector<double> & candidate, double & cost)
+{
+    try { return functor(candidate.data(), &cost); }
+    catch (const std::exception & e) { ReportEvaluationError(workDir, candidate, e.what()); }
+    catch (...) { ReportEvaluationError(workDir, candidate, "unknown exception"); }
+    return false;
+}
+
+// evaluates a batch of candidates concurrently, one cost functor per worker,
+// each worker owns a private work dir so simulation outputs never collide
+template <typename CostFunctor>
+class BatchEvaluator
+{
+public:
+    template <typename... Args>
+    BatchEvaluator(size_t workers, const std::string & workDir, const Args &... args)
+     : m_pool(std::max<size_t>(1, workers))
+    {
+        workers = std::max<size_t>(1, workers);
+        m_functors.reserve(workers);
+        for (size_t i = 0; i < workers; ++i) {
+            auto dir = WorkerDir(workDir, i);
+            std::filesystem::create_directories(dir);
+            m_functors.emplace_back(args..., dir);
+            m_dirs.emplace_back(dir);
+        }
+    }
+
+    size_t Workers() const { return m_functors.size(); }
+
+    CostFunctor & Functor(size_t worker) { return m_functors.at(worker); }
+
+    // returns cost of each candidate, infeasible or failed candidates get max double
+    std::vector<double> Evaluate(const std::vector<std::vector<double> > & candidates)
+    {
+        std::vector<double> costs(candidates.size(), std::numeric_limits<double>::max());
+        std::vector<std::future<void> > futures;
+        for (size_t w = 0; w < std::min(Workers(), candidates.size()); ++w) {
+            auto promise = std::make_shared<std::promise<void> >();
+            futures.emplace_back(promise->get_future());
+            m_pool.Submit([&, w, promise]{
+                for (size_t i = w; i < candidates.size(); i += Workers()) {
+                    double cost{0};
+                    if (EvaluateCandidate(m_functors[w], m_dirs[w], candidates[i], cost)) costs[i] = cost;
+                }
+                promise->set_value();
+            });
+        }
+        for (auto & future : futures) future.wait();
+        return costs;
+    }
+
+    static std::string WorkerDir(const std::string & workDir, size_t worker)
+    {
+        return (std::filesystem::path(workDir) / ("worker" + std::to_string(worker))).string();
+    }
+
+private:
+    std::vector<CostFunctor> m_functors;
+    std::vector<std::string> m_dirs;
+    generic::thread::ThreadPool m_pool;
+};
+
+} // namespace eopt
@@ -0,0 +1,223 @@
+#pragma once
+#include "LayoutOverlay.hpp"
+#include "EDataMgr.h"
+#include <unordered_map>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <array>
+#include <cmath>
+
+namespace eopt {
+
+struct Box
+{
+    double xmin{0}, ymin{0}, xmax{0}, ymax{0};
+    Box Shifted(double dx, double dy) const { return {xmin + dx, ymin + dy, xmax + dx, ymax + dy}; }
+    Box Inflated(double d) const { return {xmin - d, ymin - d, xmax + d, ymax + d}; }
+    bool Intersects(const Box & other) const
+    {
+        return xmin < other.xmax && other.xmin < xmax && ymin < other.ymax && other.ymin < ymax;
+    }
+};
+
+// closed polygon outline, points in order without repeating the first one
+struct Contour
+{
+    Box bbox;
+    std::vector<std::array<double, 2> > points;
+
+    explicit Contour(std::vector<std::array<double, 2> > pts) : points(std::move(pts))
+    {
+        if (points.empty()) return;
+        bbox = {points.front()[0], points.front()[1], points.front()[0], points.front()[1]};
+        for (const auto & p : points)
+            bbox = {std::min(bbox.xmin, p[0]), std::min(bbox.ymin, p[1]), std::max(bbox.xmax, p[0]), std::max(bbox.ymax, p[1])};
+    }
+
+    // the box lies inside or on the outline: its corners are not outside and no edge runs through its interior
+    bool Contains(const Box & box) const
+    {
+        if (box.xmin < bbox.xmin || box.ymin < bbox.ymin || bbox.xmax < box.xmax || bbox.ymax < box.ymax) return false;
+        for (auto [x, y] : {std::array<double, 2>{box.xmin, box.ymin}, {box.xmax, box.ymin}, {box.xmax, box.ymax}, {box.xmin, box.ymax}})
+            if (not Covers(x, y)) return false;
+        for (size_t i = 0; i < points.size(); ++i)
+            if (CrossesInterior(points[i], points[(i + 1) % points.size()], box)) return false;
+        return true;
+    }
+
+private:
+    // point inside or on the outline, even-odd rule
+    bool Covers(double x, double y) const
+    {
+        bool inside{false};
+        for (size_t i = 0, j = points.size() - 1; i < points.size(); j = i++) {
+            const auto & a = points[j], & b = points[i];
+            auto cross = (b[0] - a[0]) * (y - a[1]) - (b[1] - a[1]) * (x - a[0]);
+            if (cross == 0 && std::min(a[0], b[0]) <= x && x <= std::max(a[0], b[0]) &&
+                std::min(a[1], b[1]) <= y && y <= std::max(a[1], b[1])) return true;
+            if ((a[1] > y) != (b[1] > y) && x < a[0] + (y - a[1]) * (b[0] - a[0]) / (b[1] - a[1])) inside = not inside;
+        }
+        return inside;
+    }
+
+    // clips the segment to the closed box, a chord of the box not lying on its border passes through the interior
+    static bool CrossesInterior(const std::array<double, 2> & a, const std::array<double, 2> & b, const Box & box)
+    {
+        double t0{0}, t1{1};
+        const double d[] = {b[0] - a[0], b[1] - a[1]};
+        const double lo[] = {box.xmin, box.ymin}, hi[] = {box.xmax, box.ymax};
+        for (size_t k = 0; k < 2; ++k) {
+            if (d[k] == 0) {
+                if (a[k] < lo[k] || hi[k] < a[k]) return false;
+                continue;
+            }
+            auto ta = (lo[k] - a[k]) / d[k], tb = (hi[k] - a[k]) / d[k];
+            t0 = std::max(t0, std::min(ta, tb));
+            t1 = std::min(t1, std::max(ta, tb));
+            if (t0 > t1) return false;
+        }
+        auto t = (t0 + t1) / 2;
+        auto x = a[0] + t * d[0], y = a[1] + t * d[1];
+        return box.xmin < x && x < box.xmax && box.ymin < y && y < box.ymax;
+    }
+};
+
+// uniform grid over boxes, query returns ids of boxes sharing a cell with the query box
+class GridIndex
+{
+public:
+    explicit GridIndex(double cellSize) : m_cellSize(cellSize) {}
+
+    double CellSize() const { return m_cellSize; }
+
+    void Insert(size_t id, const Box & box)
+    {
+        ForEachCell(box, [&](long long key) { m_cells[key].emplace_back(id); });
+        m_boxes.emplace(id, box);
+    }
+
+    std::vector<size_t> Query(const Box & box) const
+    {
+        std::vector<size_t> result;
+        ForEachCell(box, [&](long long key) {
+            auto iter = m_cells.find(key);
+            if (iter == m_cells.cend()) return;
+            for (auto id : iter->second)
+                if (m_boxes.at(id).Intersects(box)) result.emplace_back(id);
+        });
+        std::sort(result.begin(), result.end());
+        result.erase(std::unique(result.begin(), result.end()), result.end());
+        return result;
+    }
+
+private:
+    template <typename Func>
+    void ForEachCell(const Box & box, Func && func) const
+    {
+        auto x0 = static_cast<long long>(std::floor(box.xmin / m_cellSize)), x1 = static_cast<long long>(std::floor(box.xmax / m_cellSize));
+        auto y0 = static_cast<long long>(std::floor(box.ymin / m_cellSize)), y1 = static_cast<long long>(std::floor(box.ymax / m_cellSize));
+        for (auto x = x0; x <= x1; ++x)
+            for (auto y = y0; y <= y1; ++y)
+                func(x * 1000003 + y);
+    }
+
+private:
+    double m_cellSize;
+    std::unordered_map<long long, std::vector<size_t> > m_cells;
+    std::unordered_map<size_t, Box> m_boxes;
+};
+
+// checks a design delta against the geometry of the flattened base layout before it is simulated:
+// shifted components must not overlap each other nor cover a bondwire landing point on a layer, and a component
+// sitting on a copper shape in the base design must stay within that shape
+class FeasibilityChecker
+{
+public:
+    enum class Violation { None, ComponentOverlap, BondwireLanding, PadOverhang };
+
+    struct Report
+    {
+        Violation violation{Violation::None};
+        std::string detail;
+        explicit operator bool() const { return violation == Violation::None; }
+    };
+
+    // clearance, landing radius and pad margin are in design units, the pad margin is the copper
+    // a component keeps to the edge of the shape it sits on
+    explicit FeasibilityChecker(ecad::CPtr<ecad::ILayoutView> layout, double clearance = 0, double landingRadius = 300, double padMargin = 0, double cellSize = 2000)
+     : m_coordUnits(layout->GetCoordUnits()), m_landings(m_coordUnits.toCoord(cellSize))
+    {
+        m_clearance = m_coordUnits.toCoord(clearance);
+        m_padMargin = m_coordUnits.toCoord(padMargin);
+        auto radius = m_coordUnits.toCoord(landingRadius);
+        std::vector<std::pair<ecad::ELayerId, Contour> > copper;
+        auto primIter = layout->GetPrimitiveIter();
+        while (auto * prim = primIter->Next()) {
+            if (auto * geom = prim->GetGeometry2DFromPrimitive(); geom) {
+                std::vector<std::array<double, 2> > points;
+                for (const auto & pt : geom->GetShape()->GetContour().GetPoints())
+                    points.emplace_back(std::array<double, 2>{double(pt[0]), double(pt[1])});
+                if (points.size() > 2) copper.emplace_back(prim->GetLayer(), Contour(std::move(points)));
+                continue;
+            }
+            auto * bw = prim->GetBondwireFromPrimitive();
+            if (nullptr == bw) continue;
+            auto addLanding = [&](const ecad::EPoint2D & pt) {
+                m_landings.Insert(m_landingNames.size(), Box{double(pt[0]), double(pt[1]), double(pt[0]), double(pt[1])}.Inflated(radius));
+                m_landingNames.emplace_back(bw->GetName());
+            };
+            if (nullptr == bw->GetStartComponent()) addLanding(bw->GetStartPt());
+            if (nullptr == bw->GetEndComponent()) addLanding(bw->GetEndPt());
+        }
+
+        auto compIter = layout->GetComponentIter();
+        while (auto * comp = compIter->Next()) {
+            auto bbox = comp->GetBoundingBox();
+            m_components.emplace_back(comp->GetName());
+            m_compBoxes.emplace_back(Box{double(bbox[0][0]), double(bbox[0][1]), double(bbox[1][0]), double(bbox[1][1])});
+            //bound to the copper it sits on in the base design, moving onto another shape would change its net
+            m_pads.emplace_back();
+            for (const auto & [layer, contour] : copper)
+                if (layer == comp->GetPlacementLayer() && contour.Contains(m_compBoxes.back())) m_pads.back().emplace_back(contour);
+        }
+    }
+
+    Report Check(const DesignDelta & delta) const
+    {
+        std::vector<Box> boxes(m_compBoxes);
+        for (size_t i = 0; i < m_components.size(); ++i) {
+            auto iter = delta.shifts.find(m_components[i]);
+            if (iter == delta.shifts.cend()) continue;
+            auto shift = m_coordUnits.toCoord(ecad::FPoint2D(iter->second[0], iter->second[1]));
+            boxes[i] = boxes[i].Shifted(shift[0], shift[1]);
+        }
+
+        GridIndex index(m_landings.CellSize());
+        for (size_t i = 0; i < boxes.size(); ++i) {
+            auto box = boxes[i].Inflated(m_clearance);
+            for (auto j : index.Query(box))
+                return {Violation::ComponentOverlap, m_components[j] + " overlaps " + m_components[i]};
+            index.Insert(i, boxes[i]);
+            for (auto j : m_landings.Query(box))
+                return {Violation::BondwireLanding, m_components[i] + " covers landing of " + m_landingNames[j]};
+            if (m_pads[i].empty()) continue;
+            auto footprint = boxes[i].Inflated(m_padMargin);
+            if (std::none_of(m_pads[i].cbegin(), m_pads[i].cend(), [&](const Contour & c) { return c.Contains(footprint); }))
+                return {Violation::PadOverhang, m_components[i] + " overhangs its copper"};
+        }
+        return {};
+    }
+
+private:
+    ecad::ECoordUnits m_coordUnits;
+    double m_clearance{0};
+    double m_padMargin{0};
+    std::vector<std::string> m_components;
+    std::vector<Box> m_compBoxes;
+    std::vector<std::vector<Contour> > m_pads;//copper shapes each component sits on
+    std::vector<std::string> m_landingNames;
+    GridIndex m_landings;
+};
+
+} // namespace eopt
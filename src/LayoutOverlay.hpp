@@ -0,0 +1,70 @@
+#pragma once
+#include "EDataMgr.h"
+#include <unordered_map>
+#include <string>
+
+namespace eopt {
+
+// parameter overrides against the base design, everything not listed is shared with the base
+struct DesignDelta
+{
+    std::unordered_map<std::string, ecad::FVector2D> shifts;//component name -> translation in design units
+    std::unordered_map<std::string, ecad::EFloat> thicknesses;//stackup layer name -> thickness
+};
+
+// worker local view of the base design with a delta applied, the base is cloned once
+// on first use, later deltas only revert and reapply the overrides that differ
+class LayoutOverlay
+{
+public:
+    explicit LayoutOverlay(ecad::CPtr<ecad::ILayoutView> base) : m_base(base) {}
+    LayoutOverlay(LayoutOverlay &&) = default;
+
+    ecad::Ptr<ecad::ILayoutView> Apply(const DesignDelta & delta)
+    {
+        if (nullptr == m_layout) m_layout = m_base->Clone();
+        const auto & coordUnits = m_base->GetCoordUnits();
+        auto shiftOf = [](const DesignDelta & d, const std::string & name) {
+            auto iter = d.shifts.find(name);
+            return iter == d.shifts.cend() ? ecad::FVector2D(0, 0) : iter->second;
+        };
+        auto translate = [&](const std::string & name) {
+            auto curr = shiftOf(m_applied, name), next = shiftOf(delta, name);
+            if (curr[0] == next[0] && curr[1] == next[1]) return;
+            auto comp = m_layout->FindComponentByName(name); { ECAD_ASSERT(comp) }
+            ecad::FVector2D shift(next[0] - curr[0], next[1] - curr[1]);
+            comp->AddTransform(ecad::EDataMgr::Instance().CreateTransform2D(coordUnits, 1.0, 0.0, shift));
+        };
+        for (const auto & [name, shift] : m_applied.shifts) translate(name);
+        for (const auto & [name, shift] : delta.shifts)
+            if (not m_applied.shifts.count(name)) translate(name);
+
+        for (const auto & [name, thickness] : m_applied.thicknesses) {
+            if (delta.thicknesses.count(name)) continue;
+            m_layout->ModifyStackupLayerThickness(name, BaseThickness(name));
+        }
+        for (const auto & [name, thickness] : delta.thicknesses) {
+            auto iter = m_applied.thicknesses.find(name);
+            if (iter != m_applied.thicknesses.cend() && iter->second == thickness) continue;
+            m_layout->ModifyStackupLayerThickness(name, thickness);
+        }
+        m_applied = delta;
+        return m_layout.get();
+    }
+
+    ecad::EFloat BaseThickness(const std::string & layerName) const
+    {
+        auto layer = m_base->FindLayerByName(layerName); { ECAD_ASSERT(layer) }
+        auto stackupLayer = layer->GetStackupLayerFromLayer(); { ECAD_ASSERT(stackupLayer) }
+        return stackupLayer->GetThickness();
+    }
+
+    ecad::CPtr<ecad::ILayoutView> Base() const { return m_base; }
+
+private:
+    ecad::CPtr<ecad::ILayoutView> m_base;
+    ecad::UPtr<ecad::ILayoutView> m_layout;
+    DesignDelta m_applied;
+};
+
+} // namespace eopt
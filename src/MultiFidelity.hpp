@@ -0,0 +1,52 @@
+#pragma once
+#include <cstddef>
+#include <mutex>
+#include <cmath>
+
+namespace eopt {
+
+enum class Fidelity { Coarse, Fine };
+
+inline const char * toString(Fidelity fidelity)
+{
+    return fidelity == Fidelity::Coarse ? "coarse" : "fine";
+}
+
+// per-run linear map from coarse to fine cost, fitted by least squares on promoted candidates
+class FidelityCorrection
+{
+public:
+    void Add(double coarse, double fine)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_n += 1;
+        m_sx += coarse; m_sy += fine;
+        m_sxx += coarse * coarse; m_sxy += coarse * fine;
+    }
+
+    double operator() (double coarse) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_n < 1) return coarse;
+        auto offset = (m_sy - m_sx) / m_n;
+        if (m_n < 3) return coarse + offset;
+        auto var = m_n * m_sxx - m_sx * m_sx;
+        if (std::abs(var) < 1e-12 * m_n * m_sxx) return coarse + offset;
+        auto slope = (m_n * m_sxy - m_sx * m_sy) / var;
+        auto intercept = (m_sy - slope * m_sx) / m_n;
+        return intercept + slope * coarse;
+    }
+
+    size_t Samples() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_n;
+    }
+
+private:
+    mutable std::mutex m_mutex;
+    size_t m_n{0};
+    double m_sx{0}, m_sy{0}, m_sxx{0}, m_sxy{0};
+};
+
+} // namespace eopt
@@ -0,0 +1,57 @@
+#pragma once
+#include "ceres/ceres.h"
+#include "Evaluator.hpp"
+#include <limits>
+#include <mutex>
+
+namespace eopt {
+
+// forward difference cost function whose N + 1 evaluations per jacobian run concurrently on
+// a batch evaluator, so a gradient costs about one simulation of wall time given N + 1 workers.
+// do not attach an evaluation cache whose resolution is not far below the step to its functors
+template <typename CostFunctor, int N>
+class ParallelDiffCostFunction : public ceres::SizedCostFunction<1, N>
+{
+public:
+    template <typename... Args>
+    ParallelDiffCostFunction(double step, size_t workers, const std::string & workDir, const Args &... args)
+     : m_step(step), m_evaluator(workers, workDir, args...)
+    {
+    }
+
+    BatchEvaluator<CostFunctor> & Evaluator() { return m_evaluator; }
+
+    bool Evaluate(double const * const * parameters, double * residuals, double ** jacobians) const override
+    {
+        std::vector<std::vector<double> > candidates(1, std::vector<double>(parameters[0], parameters[0] + N));
+        const bool needJacobian = jacobians && jacobians[0];
+        std::vector<double> steps(N, 0);
+        if (needJacobian) {
+            for (int i = 0; i < N; ++i) {
+                auto x = candidates.front();
+                steps[i] = x[i] + m_step > 1 ? -m_step : m_step;
+                x[i] += steps[i];
+                candidates.emplace_back(std::move(x));
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto costs = m_evaluator.Evaluate(candidates);
+        for (auto cost : costs)
+            if (cost == std::numeric_limits<double>::max()) return false;
+
+        residuals[0] = costs.front();
+        if (needJacobian) {
+            for (int i = 0; i < N; ++i)
+                jacobians[0][i] = (costs.at(i + 1) - costs.front()) / steps[i];
+        }
+        return true;
+    }
+
+private:
+    double m_step;
+    mutable std::mutex m_mutex;
+    mutable BatchEvaluator<CostFunctor> m_evaluator;
+};
+
+} // namespace eopt
@@ -0,0 +1,102 @@
+#pragma once
+#include <sys/resource.h>
+#include <unistd.h>
+#include <algorithm>
+#include <fstream>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <mutex>
+
+namespace eopt {
+
+// wall time of each phase of one cost evaluation in seconds, mesh generation, matrix assembly
+// and solve all happen inside RunThermalSimulation and are reported together as simulate
+struct EvaluationProfile
+{
+    double apply{0};//revert and apply design delta, includes the clone on first use
+    double simulate{0};
+    double total{0};
+    bool cached{false};
+    size_t rss{0};//bytes
+    size_t peakRss{0};//bytes
+};
+
+// adds the elapsed wall time to target when going out of scope
+class ScopedTimer
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    explicit ScopedTimer(double & target) : m_target(target), m_start(Clock::now()) {}
+    ~ScopedTimer() { m_target += std::chrono::duration<double>(Clock::now() - m_start).count(); }
+private:
+    double & m_target;
+    Clock::time_point m_start;
+};
+
+// collects evaluation profiles from all workers, optionally streaming them as csv rows
+class Profiler
+{
+public:
+    explicit Profiler(const std::string & filename = {})
+    {
+        if (filename.empty()) return;
+        m_out.open(filename);
+        m_out << "worker,cached,apply,simulate,total,rss,peak_rss" << std::endl;
+    }
+
+    void Record(const std::string & worker, EvaluationProfile profile)
+    {
+        profile.rss = CurrentRss();
+        profile.peakRss = PeakRss();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_profiles.emplace_back(profile);
+        if (not m_out.is_open()) return;
+        m_out << worker << ',' << profile.cached << ',' << profile.apply << ',' << profile.simulate << ','
+              << profile.total << ',' << profile.rss << ',' << profile.peakRss << '\n';
+    }
+
+    std::vector<EvaluationProfile> Profiles() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_profiles;
+    }
+
+    // percentile in [0, 1] of the total evaluation latency
+    double Latency(double percentile) const
+    {
+        std::vector<double> latencies;
+        for (const auto & profile : Profiles())
+            latencies.emplace_back(profile.total);
+        if (latencies.empty()) return 0;
+        auto index = std::min(latencies.size() - 1, static_cast<size_t>(percentile * latencies.size()));
+        std::nth_element(latencies.begin(), latencies.begin() + index, latencies.end());
+        return latencies.at(index);
+    }
+
+    static size_t CurrentRss()
+    {
+        size_t pages{0}, resident{0};
+        std::ifstream in("/proc/self/statm");
+        if (in >> pages >> resident) return resident * ::sysconf(_SC_PAGESIZE);
+        return 0;
+    }
+
+    static size_t PeakRss()
+    {
+        struct rusage usage;
+        if (::getrusage(RUSAGE_SELF, &usage)) return 0;
+#ifdef __APPLE__
+        return usage.ru_maxrss;
+#else
+        return usage.ru_maxrss * 1024;
+#endif
+    }
+
+private:
+    mutable std::mutex m_mutex;
+    std::ofstream m_out;
+    std::vector<EvaluationProfile> m_profiles;
+};
+
+} // namespace eopt
@@ -0,0 +1,161 @@
+#pragma once
+#include <zlib.h>
+#include <unistd.h>
+#include <filesystem>
+#include <stdexcept>
+#include <functional>
+#include <fstream>
+#include <cstdint>
+#include <cstring>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <set>
+
+namespace eopt {
+
+// receives the outcome of every simulated candidate and decides whether raw data is dumped
+// and into which directory, consume gets the directory the simulation ran in
+class ResultSink
+{
+public:
+    virtual ~ResultSink() = default;
+    virtual bool DumpRawData() const = 0;
+    virtual std::string RawDataDir(const std::string & workDir) { return workDir; }
+    virtual void Consume(const std::string & workDir, const std::vector<double> & parameters, double minT, double maxT) = 0;
+};
+
+// keeps only the reductions in memory, nothing is written to disk
+class MemoryResultSink : public ResultSink
+{
+public:
+    struct Reduction
+    {
+        std::vector<double> parameters;
+        double minT{0}, maxT{0};
+        double Ripple() const { return maxT - minT; }
+    };
+
+    bool DumpRawData() const override { return false; }
+
+    void Consume(const std::string &, const std::vector<double> & parameters, double minT, double maxT) override
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_reductions.emplace_back(Reduction{parameters, minT, maxT});
+    }
+
+    std::vector<Reduction> Reductions() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_reductions;
+    }
+
+private:
+    mutable std::mutex m_mutex;
+    std::vector<Reduction> m_reductions;
+};
+
+// leaves the raw data dumped by the simulation in the worker directory
+class DiskResultSink : public ResultSink
+{
+public:
+    bool DumpRawData() const override { return true; }
+    void Consume(const std::string &, const std::vector<double> &, double, double) override {}
+};
+
+// runs every simulation in a fresh directory under a node local scratch dir, then packs the raw data dumped
+// there into one zlib compressed stream and removes the directory, so only the archive reaches shared storage;
+// the raw dump itself still hits the scratch disk since the simulation writes files.
+// record layout: u32 name size, name, u64 raw size, u64 compressed size, compressed bytes
+class ArchiveResultSink : public ResultSink
+{
+public:
+    inline static constexpr char MAGIC[] = "EOPTRAW1";
+    explicit ArchiveResultSink(const std::string & filename, int level = Z_BEST_SPEED, std::string scratchDir = std::filesystem::temp_directory_path().string())
+     : m_level(level), m_scratchDir(std::move(scratchDir)), m_out(filename, std::ios::binary | std::ios::trunc)
+    {
+        m_out.write(MAGIC, sizeof(MAGIC));
+    }
+
+    bool DumpRawData() const override { return true; }
+
+    std::string RawDataDir(const std::string &) override
+    {
+        auto dir = std::filesystem::path(m_scratchDir) / ("eopt." + std::to_string(::getpid()) + "." + std::to_string(m_dirs++));
+        std::filesystem::create_directories(dir);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return *m_owned.emplace(dir.string()).first;
+    }
+
+    // only accepts directories handed out by RawDataDir, never the working directory of the process
+    void Consume(const std::string & workDir, const std::vector<double> &, double, double) override
+    {
+        namespace fs = std::filesystem;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (not m_owned.erase(workDir) || fs::equivalent(workDir, fs::current_path()))
+                throw std::invalid_argument("refusing to archive and remove " + workDir + ", not a directory created by this sink");
+        }
+        auto prefix = std::to_string(m_evaluations++) + "/";
+        std::vector<fs::path> files;
+        for (const auto & entry : fs::recursive_directory_iterator(workDir))
+            if (entry.is_regular_file()) files.emplace_back(entry.path());
+
+        for (const auto & file : files) {
+            std::ifstream in(file, std::ios::binary);
+            std::vector<char> raw((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+            uLongf size = ::compressBound(raw.size());
+            std::vector<Bytef> compressed(size);
+            if (Z_OK != ::compress2(compressed.data(), &size, reinterpret_cast<const Bytef *>(raw.data()), raw.size(), m_level)) continue;
+            auto name = prefix + fs::relative(file, workDir).generic_string();
+            std::lock_guard<std::mutex> lock(m_mutex);
+            Write(static_cast<uint32_t>(name.size()));
+            m_out.write(name.data(), name.size());
+            Write(static_cast<uint64_t>(raw.size()));
+            Write(static_cast<uint64_t>(size));
+            m_out.write(reinterpret_cast<const char *>(compressed.data()), size);
+        }
+        fs::remove_all(workDir);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_out.flush();
+    }
+
+    // calls reader with name and decompressed content of every record in the archive
+    static bool Read(const std::string & filename, const std::function<void(const std::string &, const std::vector<char> &)> & reader)
+    {
+        std::ifstream in(filename, std::ios::binary);
+        char magic[sizeof(MAGIC)];
+        if (not in.read(magic, sizeof(MAGIC)) || std::memcmp(magic, MAGIC, sizeof(MAGIC))) return false;
+        uint32_t nameSize;
+        while (in.read(reinterpret_cast<char *>(&nameSize), sizeof(nameSize))) {
+            std::string name(nameSize, '\0');
+            uint64_t rawSize{0}, compressedSize{0};
+            in.read(name.data(), nameSize);
+            in.read(reinterpret_cast<char *>(&rawSize), sizeof(rawSize));
+            in.read(reinterpret_cast<char *>(&compressedSize), sizeof(compressedSize));
+            std::vector<Bytef> compressed(compressedSize);
+            if (not in.read(reinterpret_cast<char *>(compressed.data()), compressedSize)) return false;
+            std::vector<char> raw(rawSize);
+            uLongf size = rawSize;
+            if (Z_OK != ::uncompress(reinterpret_cast<Bytef *>(raw.data()), &size, compressed.data(), compressedSize)) return false;
+            reader(name, raw);
+        }
+        return true;
+    }
+
+private:
+    template <typename T>
+    void Write(T value) { m_out.write(reinterpret_cast<const char *>(&value), sizeof(T)); }
+
+private:
+    int m_level;
+    std::string m_scratchDir;
+    std::mutex m_mutex;
+    std::ofstream m_out;
+    std::set<std::string> m_owned;
+    std::atomic<size_t> m_dirs{0};
+    std::atomic<size_t> m_evaluations{0};
+};
+
+} // namespace eopt
@@ -0,0 +1,145 @@
+#pragma once
+#include <Eigen/Dense>
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <vector>
+#include <cmath>
+
+namespace eopt {
+
+// n stratified samples per dimension in [lower, upper], strata randomly paired across dimensions
+template <typename RandomEngine>
+std::vector<std::vector<double> > LatinHypercube(size_t n, size_t dim, double lower, double upper, RandomEngine & rng)
+{
+    std::uniform_real_distribution<double> uniform(0, 1);
+    std::vector<std::vector<double> > samples(n, std::vector<double>(dim));
+    std::vector<size_t> strata(n);
+    for (size_t d = 0; d < dim; ++d) {
+        std::iota(strata.begin(), strata.end(), 0);
+        std::shuffle(strata.begin(), strata.end(), rng);
+        for (size_t i = 0; i < n; ++i)
+            samples[i][d] = lower + (upper - lower) * (strata[i] + uniform(rng)) / n;
+    }
+    return samples;
+}
+
+// gaussian process regression with squared exponential kernel, the length scale is
+// picked from a fixed grid by maximum marginal likelihood on every fit
+class GaussianProcess
+{
+public:
+    // the noise term grows tenfold until a factorization succeeds, returns false if none does
+    bool Fit(const std::vector<std::vector<double> > & x, const std::vector<double> & y)
+    {
+        const auto n = x.size();
+        m_x.resize(n, n ? x.front().size() : 0);
+        for (size_t i = 0; i < n; ++i)
+            m_x.row(i) = Eigen::Map<const Eigen::VectorXd>(x[i].data(), x[i].size());
+        Eigen::VectorXd target = Eigen::Map<const Eigen::VectorXd>(y.data(), n);
+        m_mean = target.mean();
+        m_scale = n > 1 ? std::sqrt((target.array() - m_mean).square().sum() / (n - 1)) : 1;
+        if (m_scale < 1e-12) m_scale = 1;
+        target = (target.array() - m_mean) / m_scale;
+
+        m_alpha.resize(0);
+        for (m_noise = 1e-6; m_noise <= 1e-1; m_noise *= 10) {
+            double bestLikelihood = -std::numeric_limits<double>::max();
+            for (auto length : {0.05, 0.1, 0.2, 0.4, 0.8, 1.6}) {
+                Eigen::LLT<Eigen::MatrixXd> llt(Kernel(m_x, m_x, length) + Eigen::MatrixXd::Identity(n, n) * m_noise);
+                if (llt.info() != Eigen::Success) continue;
+                Eigen::VectorXd alpha = llt.solve(target);
+                double logDet = 2 * llt.matrixLLT().diagonal().array().log().sum();
+                double likelihood = -0.5 * target.dot(alpha) - 0.5 * logDet;
+                if (likelihood > bestLikelihood) {
+                    bestLikelihood = likelihood;
+                    m_length = length;
+                    m_alpha = std::move(alpha);
+                    m_llt = std::move(llt);
+                }
+            }
+            if (Fitted()) return true;
+        }
+        return false;
+    }
+
+    bool Fitted() const { return m_x.rows() > 0 && m_alpha.size() == m_x.rows(); }
+
+    // returns predictive mean and standard deviation in the original cost scale
+    std::pair<double, double> Predict(const std::vector<double> & x) const
+    {
+        Eigen::MatrixXd point = Eigen::Map<const Eigen::VectorXd>(x.data(), x.size()).transpose();
+        Eigen::VectorXd k = Kernel(m_x, point, m_length).col(0);
+        double mean = k.dot(m_alpha);
+        double variance = std::max(0.0, 1 + m_noise - k.dot(m_llt.solve(k)));
+        return {m_mean + mean * m_scale, std::sqrt(variance) * m_scale};
+    }
+
+    size_t Samples() const { return m_x.rows(); }
+
+private:
+    static Eigen::MatrixXd Kernel(const Eigen::MatrixXd & a, const Eigen::MatrixXd & b, double length)
+    {
+        Eigen::MatrixXd k(a.rows(), b.rows());
+        for (Eigen::Index i = 0; i < a.rows(); ++i)
+            for (Eigen::Index j = 0; j < b.rows(); ++j)
+                k(i, j) = std::exp(-0.5 * (a.row(i) - b.row(j)).squaredNorm() / (length * length));
+        return k;
+    }
+
+private:
+    double m_noise{1e-6};
+    double m_length{0.2};
+    double m_mean{0};
+    double m_scale{1};
+    Eigen::MatrixXd m_x;
+    Eigen::VectorXd m_alpha;
+    Eigen::LLT<Eigen::MatrixXd> m_llt;
+};
+
+// expected improvement below the current best for a minimization problem
+inline double ExpectedImprovement(double mean, double sigma, double best)
+{
+    if (sigma < 1e-12) return std::max(0.0, best - mean);
+    auto z = (best - mean) / sigma;
+    auto cdf = 0.5 * std::erfc(-z / std::sqrt(2.0));
+    auto pdf = std::exp(-0.5 * z * z) / std::sqrt(2 * std::acos(-1.0));
+    return (best - mean) * cdf + sigma * pdf;
+}
+
+// picks a batch of points maximizing expected improvement over a random pool plus perturbations
+// of the incumbent, later picks assume earlier ones return the predicted mean (kriging believer),
+// stops early with the picks so far if the surrogate cannot be fitted
+template <typename RandomEngine>
+std::vector<std::vector<double> > ProposeBatch(std::vector<std::vector<double> > x, std::vector<double> y, size_t batch,
+                                               double lower, double upper, RandomEngine & rng, size_t poolSize = 2000)
+{
+    GaussianProcess gp;
+    std::uniform_real_distribution<double> uniform(lower, upper);
+    std::normal_distribution<double> normal(0, 0.05 * (upper - lower));
+    std::vector<std::vector<double> > proposals;
+    for (size_t b = 0; b < batch; ++b) {
+        if (not gp.Fit(x, y)) break;
+        auto best = std::distance(y.begin(), std::min_element(y.begin(), y.end()));
+        std::vector<double> bestPoint;
+        double bestEI = -1;
+        for (size_t p = 0; p < poolSize; ++p) {
+            auto point = x.at(best);
+            for (auto & value : point)
+                value = p % 2 ? uniform(rng) : std::clamp(value + normal(rng), lower, upper);
+            auto [mean, sigma] = gp.Predict(point);
+            auto ei = ExpectedImprovement(mean, sigma, y.at(best));
+            if (ei > bestEI) {
+                bestEI = ei;
+                bestPoint = std::move(point);
+            }
+        }
+        x.emplace_back(bestPoint);
+        y.emplace_back(gp.Predict(bestPoint).first);
+        proposals.emplace_back(std::move(bestPoint));
+    }
+    return proposals;
+}
+
+} // namespace eopt
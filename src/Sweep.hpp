@@ -0,0 +1,249 @@
+#pragma once
+#include "Evaluator.hpp"
+#include "Profiler.hpp"
+#include <filesystem>
+#include <functional>
+#include <stdexcept>
+#include <algorithm>
+#include <iterator>
+#include <fstream>
+#include <cstdint>
+#include <atomic>
+#include <thread>
+#include <string>
+#include <vector>
+#include <array>
+#ifdef _OPENMP
+#include <omp.h>
+#endif//_OPENMP
+
+namespace eopt {
+
+// cartesian product of the given level values of each dimension, the last dimension varies fastest
+inline std::vector<std::vector<double> > FullFactorial(const std::vector<std::vector<double> > & levels)
+{
+    std::vector<std::vector<double> > points(1);
+    for (const auto & values : levels) {
+        std::vector<std::vector<double> > next;
+        for (const auto & point : points) {
+            for (auto value : values) {
+                next.emplace_back(point);
+                next.back().emplace_back(value);
+            }
+        }
+        points = std::move(next);
+    }
+    return points;
+}
+
+// first n points of the sobol sequence in [0, 1)^dim after the origin, gray code construction with the
+// joe-kuo (new-joe-kuo-6.21201) direction numbers, supports up to 16 dimensions
+inline std::vector<std::vector<double> > Sobol(size_t n, size_t dim)
+{
+    struct Primitive { uint32_t s, a; std::array<uint32_t, 6> m; };
+    static const Primitive primitives[] = {
+        {1,  0, {1}},                   {2,  1, {1, 3}},                {3,  1, {1, 3, 1}},
+        {3,  2, {1, 1, 1}},             {4,  1, {1, 1, 3, 3}},          {4,  4, {1, 3, 5, 13}},
+        {5,  2, {1, 1, 5, 5, 17}},      {5,  4, {1, 1, 5, 5, 5}},       {5,  7, {1, 1, 7, 11, 19}},
+        {5, 11, {1, 1, 5, 1, 1}},       {5, 13, {1, 1, 1, 3, 11}},      {5, 14, {1, 3, 5, 5, 31}},
+        {6,  1, {1, 3, 3, 9, 7, 49}},   {6, 13, {1, 1, 1, 15, 21, 21}}, {6, 16, {1, 3, 1, 13, 27, 49}}
+    };
+    constexpr size_t BITS = 32;
+    if (dim > 1 + std::size(primitives)) throw std::invalid_argument("sobol sequence supports up to 16 dimensions");
+
+    std::vector<std::array<uint32_t, BITS + 1> > directions(dim);
+    for (size_t d = 0; d < dim; ++d) {
+        auto & v = directions[d];
+        if (0 == d) {
+            for (size_t i = 1; i <= BITS; ++i) v[i] = 1u << (BITS - i);
+            continue;
+        }
+        const auto & p = primitives[d - 1];
+        for (size_t i = 1; i <= std::min<size_t>(p.s, BITS); ++i) v[i] = p.m[i - 1] << (BITS - i);
+        for (size_t i = p.s + 1; i <= BITS; ++i) {
+            v[i] = v[i - p.s] ^ (v[i - p.s] >> p.s);
+            for (size_t k = 1; k < p.s; ++k)
+                v[i] ^= ((p.a >> (p.s - 1 - k)) & 1u) * v[i - k];
+        }
+    }
+
+    std::vector<std::vector<double> > points(n, std::vector<double>(dim));
+    std::vector<uint32_t> x(dim, 0);
+    for (size_t i = 0; i < n; ++i) {
+        //index of the rightmost zero bit of i, 1 based
+        size_t c = 1;
+        for (auto value = i; value & 1; value >>= 1) ++c;
+        for (size_t d = 0; d < dim; ++d) {
+            x[d] ^= directions[d][c];
+            points[i][d] = x[d] / 4294967296.0;
+        }
+    }
+    return points;
+}
+
+// bytes of memory the kernel reports as available for new allocations without swapping
+inline size_t AvailableMemory()
+{
+    std::ifstream in("/proc/meminfo");
+    std::string key, unit;
+    size_t value{0};
+    while (in >> key >> value >> unit)
+        if (key == "MemAvailable:") return value * 1024;
+    return 0;
+}
+
+// concurrent jobs and openmp threads per job so that jobs * threads fills the cores, jobs are capped
+// by the points to run and the memory each one needs, freed cores go to the inner threads of the remaining jobs
+struct SweepSchedule
+{
+    size_t jobs{1};
+    size_t innerThreads{1};
+
+    static SweepSchedule Plan(size_t cores, size_t points, size_t innerThreads, size_t memoryPerJob, size_t availableMemory)
+    {
+        SweepSchedule schedule;
+        cores = std::max<size_t>(1, cores);
+        innerThreads = std::clamp<size_t>(innerThreads, 1, cores);
+        schedule.jobs = std::min(cores / innerThreads, std::max<size_t>(1, points));
+        if (memoryPerJob && availableMemory)
+            schedule.jobs = std::min(schedule.jobs, std::max<size_t>(1, availableMemory / memoryPerJob));
+        schedule.innerThreads = cores / schedule.jobs;
+        return schedule;
+    }
+};
+
+// one row per sweep point: parameter columns, cost, success flag and wall time, stored column-wise
+class SweepTable
+{
+public:
+    explicit SweepTable(std::vector<std::string> names, size_t rows = 0)
+     : m_names(std::move(names)), m_parameters(m_names.size(), std::vector<double>(rows, 0)),
+       m_costs(rows, 0), m_success(rows, 0), m_seconds(rows, 0)
+    {
+    }
+
+    size_t Rows() const { return m_costs.size(); }
+
+    void Set(size_t row, const std::vector<double> & parameters, bool success, double cost, double seconds)
+    {
+        for (size_t c = 0; c < std::min(parameters.size(), m_parameters.size()); ++c)
+            m_parameters[c][row] = parameters[c];
+        m_success[row] = success;
+        m_costs[row] = cost;
+        m_seconds[row] = seconds;
+    }
+
+    const std::vector<double> & Column(size_t c) const { return m_parameters.at(c); }
+    const std::vector<double> & Costs() const { return m_costs; }
+    const std::vector<uint8_t> & Success() const { return m_success; }
+    const std::vector<double> & Seconds() const { return m_seconds; }
+
+    bool WriteCsv(const std::string & filename) const
+    {
+        std::ofstream out(filename);
+        if (not out.is_open()) return false;
+        for (const auto & name : m_names) out << name << ',';
+        out << "cost,success,seconds\n";
+        for (size_t r = 0; r < Rows(); ++r) {
+            for (const auto & column : m_parameters) out << column[r] << ',';
+            out << m_costs[r] << ',' << int(m_success[r]) << ',' << m_seconds[r] << '\n';
+        }
+        return bool(out);
+    }
+
+private:
+    std::vector<std::string> m_names;
+    std::vector<std::vector<double> > m_parameters;
+    std::vector<double> m_costs;
+    std::vector<uint8_t> m_success;
+    std::vector<double> m_seconds;
+};
+
+// runs every point of a design of experiments once: the first point runs alone to measure the peak memory
+// of one job, the rest run on as many jobs as cores and memory allow, each job with its own functor and work dir
+template <typename CostFunctor>
+class SweepRunner
+{
+public:
+    using Configure = std::function<void(CostFunctor &)>;
+
+    // innerThreads is the openmp thread count one simulation uses well, memoryPerJob in bytes or 0 to measure it
+    SweepRunner(std::string workDir, size_t innerThreads = 1, size_t memoryPerJob = 0)
+     : m_workDir(std::move(workDir)), m_innerThreads(innerThreads), m_memoryPerJob(memoryPerJob)
+    {
+    }
+
+    const SweepSchedule & Schedule() const { return m_schedule; }
+    size_t MemoryPerJob() const { return m_memoryPerJob; }
+
+    template <typename... Args>
+    SweepTable Run(const std::vector<std::vector<double> > & points, const std::vector<std::string> & names, const Configure & configure, const Args &... args)
+    {
+        SweepTable table(names, points.size());
+        if (points.empty()) return table;
+
+        auto cores = std::max<unsigned>(1, std::thread::hardware_concurrency());
+        auto jobDir = [&](size_t job) { return (std::filesystem::path(m_workDir) / ("job" + std::to_string(job))).string(); };
+        auto makeFunctor = [&](size_t job) {
+            auto dir = jobDir(job);
+            std::filesystem::create_directories(dir);
+            CostFunctor functor(args..., dir);
+            if (configure) configure(functor);
+            return functor;
+        };
+
+        size_t first{0};
+        if (0 == m_memoryPerJob) {
+            auto functor = makeFunctor(0);
+            auto rss = Profiler::CurrentRss();
+            SetInnerThreads(cores);
+            Evaluate(functor, jobDir(0), points, 0, table);
+            //upper bound of what one job added on top of the resident memory before it started
+            m_memoryPerJob = Profiler::PeakRss() > rss ? Profiler::PeakRss() - rss : 0;
+            first = 1;
+        }
+        m_schedule = SweepSchedule::Plan(cores, points.size() - first, m_innerThreads, m_memoryPerJob, AvailableMemory());
+
+        std::atomic<size_t> next{first};
+        std::vector<std::thread> jobs;
+        for (size_t j = 0; j < m_schedule.jobs && first + j < points.size(); ++j) {
+            jobs.emplace_back([&, j]{
+                SetInnerThreads(m_schedule.innerThreads);
+                auto functor = makeFunctor(j);
+                for (auto i = next++; i < points.size(); i = next++)
+                    Evaluate(functor, jobDir(j), points, i, table);
+            });
+        }
+        for (auto & job : jobs) job.join();
+        return table;
+    }
+
+private:
+    static void SetInnerThreads(size_t threads)
+    {
+#ifdef _OPENMP
+        ::omp_set_num_threads(static_cast<int>(threads));//applies to parallel regions started by the calling thread
+#else
+        (void)threads;
+#endif//_OPENMP
+    }
+
+    static void Evaluate(const CostFunctor & functor, const std::string & workDir, const std::vector<std::vector<double> > & points, size_t i, SweepTable & table)
+    {
+        double cost{0}, seconds{0};
+        bool success{false};
+        {
+            ScopedTimer timer(seconds);
+            success = EvaluateCandidate(functor, workDir, points[i], cost);
+        }
+        table.Set(i, points[i], success, cost, seconds);//rows are disjoint across jobs
+    }
+
+private:
+    std::string m_workDir;
+    size_t m_innerThreads;
+    size_t m_memoryPerJob;
+    SweepSchedule m_schedule;
+};
+
+} // namespace eopt
@@ -0,0 +1,226 @@
+#pragma once
+#include "Evaluator.hpp"
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <poll.h>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <cstdint>
+#include <csignal>
+#include <cerrno>
+#include <chrono>
+#include <stdexcept>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+#include <deque>
+
+namespace eopt {
+
+// evaluates candidates in forked worker processes talking over unix domain socket pairs, each process
+// owns its cost functor and its copy of the library state, so a crash or hang only costs a restart.
+// request: u32 parameter count, doubles; reply: u8 success, double cost.
+// workers are forked from the calling thread, the caller should not run other threads at that time
+template <typename CostFunctor>
+class WorkerFarm
+{
+public:
+    using Factory = std::function<std::unique_ptr<CostFunctor>(const std::string & workDir)>;
+
+    // timeout in seconds per evaluation, 0 waits forever, a candidate is retried maxRetry times
+    // after its worker crashed or hung, then it is scored as failed
+    WorkerFarm(size_t workers, const std::string & workDir, Factory factory, double timeout = 0, size_t maxRetry = 1)
+     : m_workDir(workDir), m_factory(std::move(factory)), m_timeout(timeout), m_maxRetry(maxRetry)
+    {
+        m_workers.resize(std::max<size_t>(1, workers));
+        for (size_t w = 0; w < m_workers.size(); ++w) {
+            std::filesystem::create_directories(WorkerDir(w));
+            Spawn(w);
+        }
+    }
+
+    ~WorkerFarm()
+    {
+        for (auto & worker : m_workers) {
+            if (worker.fd >= 0) ::close(worker.fd);//an idle child leaves its loop on eof
+            if (worker.pid <= 0) continue;
+            if (worker.busy) ::kill(worker.pid, SIGKILL);//a busy one may never finish its evaluation
+            ::waitpid(worker.pid, nullptr, 0);
+        }
+    }
+
+    WorkerFarm(const WorkerFarm &) = delete;
+    WorkerFarm & operator= (const WorkerFarm &) = delete;
+
+    size_t Workers() const { return m_workers.size(); }
+    size_t Restarts() const { return m_restarts; }
+
+    // returns cost of each candidate, infeasible or failed candidates get max double
+    std::vector<double> Evaluate(const std::vector<std::vector<double> > & candidates)
+    {
+        std::vector<double> costs(candidates.size(), std::numeric_limits<double>::max());
+        std::vector<size_t> attempts(candidates.size(), 0);
+        std::deque<size_t> pending;
+        for (size_t i = 0; i < candidates.size(); ++i) pending.emplace_back(i);
+
+        size_t finished{0};
+        auto retry = [&](size_t i) {
+            if (++attempts[i] <= m_maxRetry) pending.emplace_front(i);
+            else ++finished;
+        };
+
+        while (finished < candidates.size()) {
+            for (size_t w = 0; w < m_workers.size() && not pending.empty(); ++w) {
+                auto & worker = m_workers[w];
+                if (worker.busy) continue;
+                auto i = pending.front();
+                pending.pop_front();
+                uint32_t size = candidates[i].size();
+                if (not Write(worker.fd, &size, sizeof(size)) || not Write(worker.fd, candidates[i].data(), size * sizeof(double))) {
+                    Restart(w);
+                    retry(i);
+                    continue;
+                }
+                worker.busy = true;
+                worker.candidate = i;
+                worker.start = Clock::now();
+            }
+
+            std::vector<pollfd> fds;
+            std::vector<size_t> polled;
+            for (size_t w = 0; w < m_workers.size(); ++w) {
+                if (not m_workers[w].busy) continue;
+                fds.emplace_back(pollfd{m_workers[w].fd, POLLIN, 0});
+                polled.emplace_back(w);
+            }
+            if (fds.empty()) continue;
+
+            if (::poll(fds.data(), fds.size(), m_timeout > 0 ? 100 : -1) < 0 && errno != EINTR) {
+                //late replies of the running workers would be credited to candidates of the next call
+                for (auto w : polled) Restart(w);
+                break;
+            }
+            for (size_t k = 0; k < fds.size(); ++k) {
+                auto w = polled[k];
+                auto & worker = m_workers[w];
+                auto i = worker.candidate;
+                if (fds[k].revents) {
+                    uint8_t success{0};
+                    double cost{0};
+                    if (Read(worker.fd, &success, sizeof(success)) && Read(worker.fd, &cost, sizeof(cost))) {
+                        if (success) costs[i] = cost;
+                        worker.busy = false;
+                        ++finished;
+                    }
+                    else {
+                        std::cout << "worker" << w << " died, restarting" << std::endl;
+                        Restart(w);
+                        retry(i);
+                    }
+                }
+                else if (m_timeout > 0 && std::chrono::duration<double>(Clock::now() - worker.start).count() > m_timeout) {
+                    std::cout << "worker" << w << " timed out, restarting" << std::endl;
+                    Restart(w);
+                    retry(i);
+                }
+            }
+        }
+        return costs;
+    }
+
+    std::string WorkerDir(size_t worker) const
+    {
+        return (std::filesystem::path(m_workDir) / ("worker" + std::to_string(worker))).string();
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+    struct Worker
+    {
+        pid_t pid{-1};
+        int fd{-1};
+        bool busy{false};
+        size_t candidate{0};
+        Clock::time_point start;
+    };
+
+    void Spawn(size_t w)
+    {
+        int fds[2];
+        if (::socketpair(AF_UNIX, SOCK_STREAM, 0, fds)) throw std::runtime_error("failed to create socket pair");
+        std::cout.flush();//or the child repeats buffered output
+        auto pid = ::fork();
+        if (pid < 0) throw std::runtime_error("failed to fork worker process");
+        if (0 == pid) {
+            ::close(fds[0]);
+            for (const auto & worker : m_workers)
+                if (worker.fd >= 0) ::close(worker.fd);
+            Serve(fds[1], WorkerDir(w));
+            ::_exit(EXIT_SUCCESS);
+        }
+        ::close(fds[1]);
+        m_workers[w] = Worker{pid, fds[0]};
+    }
+
+    void Restart(size_t w)
+    {
+        auto & worker = m_workers[w];
+        ::close(worker.fd);
+        worker.fd = -1;//or the next child closes whatever socket reuses the number
+        ::kill(worker.pid, SIGKILL);
+        ::waitpid(worker.pid, nullptr, 0);
+        ++m_restarts;
+        Spawn(w);
+    }
+
+    void Serve(int fd, const std::string & workDir)
+    {
+        auto functor = m_factory(workDir);
+        uint32_t size{0};
+        while (Read(fd, &size, sizeof(size))) {
+            std::vector<double> parameters(size);
+            if (not Read(fd, parameters.data(), size * sizeof(double))) break;
+            double cost{0};
+            uint8_t success = EvaluateCandidate(*functor, workDir, parameters, cost);
+            if (not Write(fd, &success, sizeof(success)) || not Write(fd, &cost, sizeof(cost))) break;
+        }
+        ::close(fd);
+    }
+
+    static bool Read(int fd, void * data, size_t size)
+    {
+        auto * p = static_cast<char *>(data);
+        while (size) {
+            auto n = ::read(fd, p, size);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            p += n; size -= n;
+        }
+        return true;
+    }
+
+    static bool Write(int fd, const void * data, size_t size)
+    {
+        auto * p = static_cast<const char *>(data);
+        while (size) {
+            auto n = ::send(fd, p, size, MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            p += n; size -= n;
+        }
+        return true;
+    }
+
+private:
+    std::string m_workDir;
+    Factory m_factory;
+    double m_timeout;
+    size_t m_maxRetry;
+    size_t m_restarts{0};
+    std::vector<Worker> m_workers;
+};
+
+} // namespace eopt
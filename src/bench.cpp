@@ -0,0 +1,88 @@
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+
+#include "generic/tools/FileSystem.hpp"
+#include "EDataMgr.h"
+#include "CostFunctor.hpp"
+#include "Evaluator.hpp"
+#include "Profiler.hpp"
+#include "Design.hpp"
+
+using namespace ecad;
+
+// replays a fixed, seeded parameter set against the reference design and reports throughput and latency
+template <typename CostFunctor>
+void Benchmark(CPtr<ILayoutView> layout, size_t evaluations, size_t workers, const std::string & csv, const std::function<void(CostFunctor &)> & configure = nullptr)
+{
+    auto profiler = std::make_shared<eopt::Profiler>(csv);
+    auto sink = std::make_shared<eopt::MemoryResultSink>();
+    eopt::BatchEvaluator<CostFunctor> evaluator(workers, generic::fs::CurrentPath() + ECAD_SEPS + "bench", layout);
+    for (size_t w = 0; w < evaluator.Workers(); ++w) {
+        evaluator.Functor(w).SetProfiler(profiler);
+        evaluator.Functor(w).SetResultSink(sink);
+        evaluator.Functor(w).SetVerbose(false);
+        if (configure) configure(evaluator.Functor(w));
+    }
+
+    std::mt19937_64 rng(0);
+    std::uniform_real_distribution<double> dist(0.1, 0.9);
+    std::vector<std::vector<double> > candidates(evaluations, std::vector<double>(CostFunctor::PARR_NUM));
+    for (auto & candidate : candidates)
+        for (auto & value : candidate) value = dist(rng);
+
+    double wall{0};
+    std::vector<double> costs;
+    {
+        eopt::ScopedTimer timer(wall);
+        costs = evaluator.Evaluate(candidates);
+    }
+    double cost{0};
+    size_t succeeded{0};
+    for (auto value : costs) {
+        if (value == std::numeric_limits<double>::max()) continue;
+        cost += value;
+        succeeded++;
+    }
+
+    double apply{0}, simulate{0};
+    auto profiles = profiler->Profiles();
+    for (const auto & profile : profiles) {
+        apply += profile.apply;
+        simulate += profile.simulate;
+    }
+    auto n = std::max<size_t>(1, profiles.size());
+    std::cout << "evaluations: " << profiles.size() << ", workers: " << evaluator.Workers() << std::endl;
+    std::cout << "wall: " << wall << "s, throughput: " << profiles.size() / wall << " evals/s" << std::endl;
+    std::cout << "latency p50: " << profiler->Latency(0.5) << "s, p99: " << profiler->Latency(0.99) << "s" << std::endl;
+    std::cout << "mean apply: " << apply / n << "s, mean simulate: " << simulate / n << "s" << std::endl;
+    std::cout << "succeeded: " << succeeded << ", mean cost: " << cost / std::max<size_t>(1, succeeded) << std::endl;
+    std::cout << "peak rss: " << eopt::Profiler::PeakRss() / 1024 / 1024 << "MB" << std::endl;
+}
+
+// usage: bench.exe [static|trans|trans-mor] [evaluations] [workers] [csv], trans-mor runs the transient
+// model with model order reduction so its timing and temperatures can be compared with trans
+int main(int argc, char * argv[])
+{
+    std::string mode = argc > 1 ? argv[1] : "static";
+    size_t evaluations = argc > 2 ? std::stoul(argv[2]) : 16;
+    size_t workers = argc > 3 ? std::stoul(argv[3]) : 1;
+    std::string csv = argc > 4 ? argv[4] : "";
+
+    EDataMgr::Instance().Init(ELogLevel::Info);
+
+    double setup{0};
+    Ptr<ILayoutView> layout{nullptr};
+    {
+        eopt::ScopedTimer timer(setup);
+        layout = SetupDesign();
+    }
+    std::cout << "design setup: " << setup << "s" << std::endl;
+
+    if (mode == "trans") Benchmark<TransientCostFunctor>(layout, evaluations, workers, csv);
+    else if (mode == "trans-mor") Benchmark<TransientCostFunctor>(layout, evaluations, workers, csv, [](TransientCostFunctor & functor) { functor.SetModelOrderReduction(true); });
+    else Benchmark<StaticCostFunctor>(layout, evaluations, workers, csv);
+    return EXIT_SUCCESS;
+}
@@ -3,16 +3,26 @@
 #include <filesystem>
 #include <cassert>
 #include <csignal>
+#include <numeric>
+#include <random>
 
 #ifdef ECAD_CERES_SOLVER_SUPPORT
 #include "glog/logging.h"
 #include "ceres/ceres.h"
+#include "ParallelDiffCostFunction.hpp"
 #endif//ECAD_CERES_SOLVER_SUPPORT
 #include "generic/thread/ThreadPool.hpp"
 #include "generic/math/MathUtility.hpp"
 #include "generic/tools/FileSystem.hpp"
 #include "generic/tools/Format.hpp"
 #include "EDataMgr.h"
+#include "CostFunctor.hpp"
+#include "Surrogate.hpp"
+#include "Evaluator.hpp"
+#include "Sweep.hpp"
+#include "Checkpoint.hpp"
+#include "WorkerFarm.hpp"
+#include "Design.hpp"
 
 using namespace ecad;
 void SignalHandler(int signum)
@@ -22,398 +32,269 @@ void SignalHandler(int signum)
     ::raise(SIGABRT);
 }
 
-Ptr<ILayoutView> SetupDesign()
-{
-    auto & eDataMgr = EDataMgr::Instance();
-
-    //database
-    auto database = eDataMgr.CreateDatabase("RobGrant");
-
-    auto matAl = database->CreateMaterialDef("Al");
-    matAl->SetProperty(EMaterialPropId::ThermalConductivity, eDataMgr.CreateSimpleMaterialProp(238));
-    matAl->SetProperty(EMaterialPropId::SpecificHeat, eDataMgr.CreateSimpleMaterialProp(880));
-    matAl->SetProperty(EMaterialPropId::MassDensity, eDataMgr.CreateSimpleMaterialProp(2700));
-    matAl->SetProperty(EMaterialPropId::Resistivity, eDataMgr.CreateSimpleMaterialProp(2.82e-8));
-
-    auto matCu = database->CreateMaterialDef("Cu");
-    matCu->SetProperty(EMaterialPropId::ThermalConductivity, eDataMgr.CreateSimpleMaterialProp(398));
-    matCu->SetProperty(EMaterialPropId::SpecificHeat, eDataMgr.CreateSimpleMaterialProp(380));
-    matCu->SetProperty(EMaterialPropId::MassDensity, eDataMgr.CreateSimpleMaterialProp(8850));
-
-    auto matAir = database->CreateMaterialDef("Air");
-    matAir->SetMaterialType(EMaterialType::Fluid);
-    matAir->SetProperty(EMaterialPropId::ThermalConductivity, eDataMgr.CreateSimpleMaterialProp(0.026));
-    matAir->SetProperty(EMaterialPropId::SpecificHeat, eDataMgr.CreateSimpleMaterialProp(1.003));
-    matAir->SetProperty(EMaterialPropId::MassDensity, eDataMgr.CreateSimpleMaterialProp(1.225));
-
-    auto matSiC = database->CreateMaterialDef("SiC");  
-    matSiC->SetProperty(EMaterialPropId::ThermalConductivity, eDataMgr.CreateSimpleMaterialProp(370));
-    matSiC->SetProperty(EMaterialPropId::SpecificHeat, eDataMgr.CreateSimpleMaterialProp(750));
-    matSiC->SetProperty(EMaterialPropId::MassDensity, eDataMgr.CreateSimpleMaterialProp(3210));
-
-    auto matSi3N4 = database->CreateMaterialDef("Si3N4");
-    matSi3N4->SetProperty(EMaterialPropId::ThermalConductivity, eDataMgr.CreateSimpleMaterialProp(70));
-    matSi3N4->SetProperty(EMaterialPropId::SpecificHeat, eDataMgr.CreateSimpleMaterialProp(691));
-    matSi3N4->SetProperty(EMaterialPropId::MassDensity, eDataMgr.CreateSimpleMaterialProp(2400));
-
-    auto matSolder = database->CreateMaterialDef("Sn-3.5Ag");
-    matSolder->SetProperty(EMaterialPropId::ThermalConductivity, eDataMgr.CreateSimpleMaterialProp(33));
-    matSolder->SetProperty(EMaterialPropId::SpecificHeat, eDataMgr.CreateSimpleMaterialProp(200));
-    matSolder->SetProperty(EMaterialPropId::MassDensity, eDataMgr.CreateSimpleMaterialProp(7360));
-    matSolder->SetProperty(EMaterialPropId::Resistivity, eDataMgr.CreateSimpleMaterialProp(11.4e-8));
-
-    //coord units
-    ECoordUnits coordUnits(ECoordUnits::Unit::Micrometer);
-    database->SetCoordUnits(coordUnits);
-    
-    //top cell
-    auto topCell = eDataMgr.CreateCircuitCell(database, "TopCell");
-    auto topLayout = topCell->GetLayoutView();
-    auto topBouds = std::make_unique<EPolygon>(eDataMgr.CreatePolygon(coordUnits, {{-5000, -5000}, {86000, -5000}, {86000, 31000}, {-5000, 31000}}));
-    topLayout->SetBoundary(std::move(topBouds));
-
-    eDataMgr.CreateNet(topLayout, "Gate");
-    eDataMgr.CreateNet(topLayout, "Drain");
-    eDataMgr.CreateNet(topLayout, "Source");
-
-    //substrate
-    [[maybe_unused]] auto iLyrTopCu = topLayout->AppendLayer(eDataMgr.CreateStackupLayer("TopCu", ELayerType::ConductingLayer, 0, 400, matCu->GetName(), matAir->GetName()));
-    [[maybe_unused]] auto iLyrSubstrate = topLayout->AppendLayer(eDataMgr.CreateStackupLayer("Substrate", ELayerType::DielectricLayer, -400, 635, matSi3N4->GetName(), matSi3N4->GetName()));
-    [[maybe_unused]] auto iLyrCuPlate = topLayout->AppendLayer(eDataMgr.CreateStackupLayer("CuPlate", ELayerType::ConductingLayer, -1035, 300, matCu->GetName(), matCu->GetName()));
-    assert(iLyrTopCu != ELayerId::noLayer);
-    assert(iLyrSubstrate != ELayerId::noLayer);
-    assert(iLyrCuPlate != ELayerId::noLayer);
-
-    //sic die
-    auto sicCell = eDataMgr.CreateCircuitCell(database, "SicDie");
-    assert(sicCell);
-    auto sicLayout = sicCell->GetLayoutView();
-    assert(sicLayout);
-
-    //boundary
-    auto sicBonds = std::make_unique<EPolygon>(eDataMgr.CreatePolygon(coordUnits, {{0, 0}, {23000, 0}, {23000, 26000}, {0, 26000}}));
-    sicLayout->SetBoundary(std::move(sicBonds));
-
-    auto iLyrWire = sicLayout->AppendLayer(eDataMgr.CreateStackupLayer("Wire", ELayerType::ConductingLayer, 0, 400, matCu->GetName(), matAir->GetName()));
-    assert(iLyrWire != ELayerId::noLayer);
-
-    //component
-    auto compDef = eDataMgr.CreateComponentDef(database, "CPMF-1200-S080B Z-FET");
-    assert(compDef);
-    compDef->SetSolderBallBumpHeight(100);
-    compDef->SetSolderFillingMaterial(matSolder->GetName());
-    compDef->SetBondingBox(eDataMgr.CreateBox(coordUnits, FPoint2D(-2000, -2000), FPoint2D(2000, 2000)));
-    compDef->SetMaterial(matSiC->GetName());
-    compDef->SetHeight(365);
-
-    eDataMgr.CreateComponentDefPin(compDef, "Gate1", {-1000,  1000}, EPinIOType::Receiver);
-    eDataMgr.CreateComponentDefPin(compDef, "Gate2", {-1000, -1000}, EPinIOType::Receiver);
-    eDataMgr.CreateComponentDefPin(compDef, "Source1", {1000,  1000}, EPinIOType::Receiver);
-    eDataMgr.CreateComponentDefPin(compDef, "Source2", {1000, -1000}, EPinIOType::Receiver);
-    
-    bool flipped{false};
-    EFloat comp1x = 2000, comp1y = 12650;
-    EFloat comp2x = 17750, comp2y = 12650; 
-    [[maybe_unused]] auto comp1 = eDataMgr.CreateComponent(sicLayout, "M1", compDef, iLyrWire, eDataMgr.CreateTransform2D(coordUnits, 1, 0, {comp1x, comp1y}), flipped);
-    [[maybe_unused]] auto comp2 = eDataMgr.CreateComponent(sicLayout, "M2", compDef, iLyrWire, eDataMgr.CreateTransform2D(coordUnits, 1, 0, {comp2x, comp2y}, EMirror2D::Y), flipped);
-    assert(comp1);
-    assert(comp2);
-    comp1->SetLossPower(33.8);
-    comp2->SetLossPower(31.9);
- 
-    //net
-    auto gateNet = eDataMgr.CreateNet(sicLayout, "Gate");
-    auto drainNet = eDataMgr.CreateNet(sicLayout, "Drain");
-    auto sourceNet = eDataMgr.CreateNet(sicLayout, "Source");
-
-    //wire
-    EFloat bwRadius = 250;//um
-    std::vector<FPoint2D> ps1 {{0, 0}, {14200, 0}, {14200, 3500}, {5750, 3500}, {5750, 9150}, {0, 9150}};
-    eDataMgr.CreateGeometry2D(sicLayout, iLyrWire, sourceNet->GetNetId(), eDataMgr.CreateShapePolygon(coordUnits, std::move(ps1)));
-
-    std::vector<FPoint2D> ps2 {{0, 10650}, {7300, 10650}, {7300, 5000}, {14300, 5000}, {14300, 19000}, {1450, 19000}, {1450, 26000}, {0, 26000}};
-    eDataMgr.CreateGeometry2D(sicLayout, iLyrWire, drainNet->GetNetId(), eDataMgr.CreateShapePolygon(coordUnits, std::move(ps2)));
-
-    std::vector<FPoint2D> ps3 {{15750, 0}, {23000, 0}, {23000, 18850}, {18000, 18850}, {18000, 26000}, {14500, 26000}, {14500, 20500}, {15750, 20500}};
-    eDataMgr.CreateGeometry2D(sicLayout, iLyrWire, drainNet->GetNetId(), eDataMgr.CreateShapePolygon(coordUnits, std::move(ps3)));
-
-    auto rec1 = eDataMgr.CreateShapeRectangle(coordUnits, FPoint2D(2500, 20500), FPoint2D(4000, 26000));
-    eDataMgr.CreateGeometry2D(sicLayout, iLyrWire, gateNet->GetNetId(), std::move(rec1));
-
-    auto rec2 = eDataMgr.CreateShapeRectangle(coordUnits, FPoint2D(5000, 20500), FPoint2D(6500, 26000));
-    eDataMgr.CreateGeometry2D(sicLayout, iLyrWire, gateNet->GetNetId(), std::move(rec2));
-
-    auto rec3 = eDataMgr.CreateShapeRectangle(coordUnits, FPoint2D(7500, 20500), FPoint2D(13500, 23000));
-    eDataMgr.CreateGeometry2D(sicLayout, iLyrWire, ENetId::noNet, std::move(rec3));
-
-    auto rec4 = eDataMgr.CreateShapeRectangle(coordUnits, FPoint2D(7500, 24000), FPoint2D(10000, 26000));
-    eDataMgr.CreateGeometry2D(sicLayout, iLyrWire, ENetId::noNet, std::move(rec4));
-
-    auto rec5 = eDataMgr.CreateShapeRectangle(coordUnits, FPoint2D(11000, 24000), FPoint2D(13500, 26000));
-    eDataMgr.CreateGeometry2D(sicLayout, iLyrWire, ENetId::noNet, std::move(rec5));
-
-    auto rec6 = eDataMgr.CreateShapeRectangle(coordUnits, FPoint2D(19000, 20500), FPoint2D(20500, 26000));
-    eDataMgr.CreateGeometry2D(sicLayout, iLyrWire, gateNet->GetNetId(), std::move(rec6));
-
-    auto rec7 = eDataMgr.CreateShapeRectangle(coordUnits, FPoint2D(21500, 20500), FPoint2D(23000, 26000));
-    eDataMgr.CreateGeometry2D(sicLayout, iLyrWire, gateNet->GetNetId(), std::move(rec7));
-
-    //bondwire
-    auto sourceBW1 = eDataMgr.CreateBondwire(sicLayout, "SourceBW1", sourceNet->GetNetId(), bwRadius);
-    sourceBW1->SetBondwireType(EBondwireType::JEDEC4);
-    sourceBW1->SetStartComponent(comp1, "Source1");
-    sourceBW1->SetEndLayer(iLyrWire, coordUnits.toCoord(FPoint2D{2500, 8700}), false);
-    sourceBW1->SetCurrent(20);
-
-    auto sourceBW2 = eDataMgr.CreateBondwire(sicLayout, "SourceBW2", sourceNet->GetNetId(), bwRadius);
-    sourceBW2->SetBondwireType(EBondwireType::JEDEC4);
-    sourceBW2->SetStartComponent(comp1, "Source2");
-    sourceBW2->SetEndLayer(iLyrWire, coordUnits.toCoord(FPoint2D{3500, 8700}), false);
-    sourceBW2->SetCurrent(20);
-
-    auto sourceBW3 = eDataMgr.CreateBondwire(sicLayout, "SourceBW3", sourceNet->GetNetId(), bwRadius);
-    sourceBW3->SetStartComponent(comp1, "Source1");
-    sourceBW3->SetEndComponent(comp2, "Source1");
-    sourceBW3->SetCurrent(10);
-
-    auto sourceBW4 = eDataMgr.CreateBondwire(sicLayout, "SourceBW4", sourceNet->GetNetId(), bwRadius);
-    sourceBW4->SetStartComponent(comp1, "Source2");
-    sourceBW4->SetEndComponent(comp2, "Source2");
-    sourceBW4->SetCurrent(10);
-
-    EFloat drainBWStartX = 13500, drainBWEndX = 16500;
-    auto drainBW1 = eDataMgr.CreateBondwire(sicLayout, "DrainBW1", drainNet->GetNetId(), bwRadius);
-    drainBW1->SetStartLayer(iLyrWire, coordUnits.toCoord(FPoint2D{drainBWStartX,  8200}), false);
-    drainBW1->SetEndLayer(iLyrWire, coordUnits.toCoord(FPoint2D{drainBWEndX, 3500}), false);
-
-    auto drainBW2 = eDataMgr.CreateBondwire(sicLayout, "DrainBW2", drainNet->GetNetId(), bwRadius);
-    drainBW2->SetStartLayer(iLyrWire, coordUnits.toCoord(FPoint2D{drainBWStartX,  6200}), false);
-    drainBW2->SetEndLayer(iLyrWire, coordUnits.toCoord(FPoint2D{drainBWEndX, 1500}), false);
-
-    EFloat gateBWEndY{21000};
-    auto gateBW1 = eDataMgr.CreateBondwire(sicLayout, "GateBW1", gateNet->GetNetId(), bwRadius);
-    gateBW1->SetBondwireType(EBondwireType::JEDEC4); 
-    gateBW1->SetStartComponent(comp1, "Gate1");
-    gateBW1->SetEndLayer(iLyrWire, coordUnits.toCoord(FPoint2D{3250, gateBWEndY}), false);
-
-    auto gateBW2 = eDataMgr.CreateBondwire(sicLayout, "GateBW2", gateNet->GetNetId(), bwRadius);
-    gateBW2->SetBondwireType(EBondwireType::JEDEC4);
-    gateBW2->SetStartComponent(comp1, "Gate2");
-    gateBW2->SetEndLayer(iLyrWire, coordUnits.toCoord(FPoint2D{5750, gateBWEndY}), false);
-
-    auto gateBW3 = eDataMgr.CreateBondwire(sicLayout, "GateBW3", gateNet->GetNetId(), bwRadius);
-    gateBW3->SetBondwireType(EBondwireType::JEDEC4);
-    gateBW3->SetStartComponent(comp2, "Gate1");
-    gateBW3->SetEndLayer(iLyrWire, coordUnits.toCoord(FPoint2D{19750, gateBWEndY}), false);
-
-    auto gateBW4 = eDataMgr.CreateBondwire(sicLayout, "GateBW4", gateNet->GetNetId(), bwRadius);
-    gateBW4->SetBondwireType(EBondwireType::JEDEC4);
-    gateBW4->SetStartComponent(comp2, "Gate2");
-    gateBW4->SetEndLayer(iLyrWire, coordUnits.toCoord(FPoint2D{22250, gateBWEndY}), false);
-    
-    auto bondwireSolderDef = eDataMgr.CreatePadstackDef(database, "Bondwire Solder Joints");
-    auto bondwireSolderDefData = eDataMgr.CreatePadstackDefData();
-    bondwireSolderDefData->SetTopSolderBumpMaterial(matSolder->GetName());
-    bondwireSolderDefData->SetBotSolderBallMaterial(matSolder->GetName());
-    
-    auto bumpR = bwRadius * 1.2 * 1e3;
-    auto topBump = eDataMgr.CreateShapeCircle({0, 0}, bumpR);
-    bondwireSolderDefData->SetTopSolderBumpParameters(std::move(topBump), 100);
-    
-    auto botBall = eDataMgr.CreateShapeCircle({0, 0}, bumpR);
-    bondwireSolderDefData->SetBotSolderBallParameters(std::move(botBall), 100);
-
-    bondwireSolderDef->SetPadstackDefData(std::move(bondwireSolderDefData));
-
-    auto primIter = sicLayout->GetPrimitiveIter();
-    while (auto * prim = primIter->Next()) {
-        if (auto * bw = prim->GetBondwireFromPrimitive(); bw) {
-            bw->SetSolderJoints(bondwireSolderDef);
-            bw->SetMaterial(matAl->GetName());
-            bw->SetHeight(500);
-        }
-    }
+using RandomEngine = std::mt19937_64;
 
-    //layer map
-    auto layerMap = eDataMgr.CreateLayerMap(database, "Layermap");
-    layerMap->SetMapping(iLyrWire, iLyrTopCu);
+RandomEngine MakeRandomEngine(size_t seed, size_t stream = 0)
+{
+    std::seed_seq seq{seed, stream};
+    return RandomEngine(seq);
+}
 
-    //instance
-    auto inst1 = eDataMgr.CreateCellInst(topLayout, "Inst1", sicLayout, eDataMgr.CreateTransform2D(coordUnits, 1, 0, {0, 0}));
-    inst1->SetLayerMap(layerMap);
+std::vector<double> RandomSolution(size_t paraNums, RandomEngine & rng)
+{
+    std::uniform_real_distribution<double> dist(0.1, 0.9);
+    std::vector<double> solution(paraNums);
+    for (auto & value : solution)
+        value = dist(rng);
+    return solution;
+}
 
-    auto inst2 = eDataMgr.CreateCellInst(topLayout, "Inst2", sicLayout, eDataMgr.CreateTransform2D(coordUnits, 1, 0, {29000, 0}));
-    inst2->SetLayerMap(layerMap);
+std::vector<double> RandomNeighbour(const std::vector<double> & original, double minStep, double maxStep, RandomEngine & rng)
+{
+    GENERIC_ASSERT(minStep < maxStep)
+    std::uniform_real_distribution<double> dist(minStep, maxStep);
+    std::bernoulli_distribution sign(0.5);
+    std::vector<double> solution(original.size());
+    for (size_t i = 0; i < solution.size(); ++i) {
+        do {
+            auto step = dist(rng);
+            step *= sign(rng) ? 1 : -1;
+            solution[i] = original.at(i) + step;
+        } while (solution[i] < 0.1 || 0.9 < solution[i]);
+    }
+    return solution;
+}
 
-    auto inst3 = eDataMgr.CreateCellInst(topLayout, "Inst3", sicLayout, eDataMgr.CreateTransform2D(coordUnits, 1, 0, {58000, 0}));
-    inst3->SetLayerMap(layerMap);
+// retries random neighbours until one passes the functor's geometric checks, the last try is returned otherwise
+template <typename CostFunctor>
+std::vector<double> FeasibleNeighbour(const CostFunctor & functor, const std::vector<double> & original, double minStep, double maxStep, RandomEngine & rng, size_t maxTry = 100)
+{
+    auto solution = RandomNeighbour(original, minStep, maxStep, rng);
+    for (size_t i = 1; i < maxTry && not functor.Feasible(solution.data()); ++i)
+        solution = RandomNeighbour(original, minStep, maxStep, rng);
+    return solution;
+}
 
-    //flatten
-    database->Flatten(topCell);
-    
-    return topCell->GetFlattenedLayoutView();
+// one geometric checker of the base layout shared by all functors, infeasible candidates fail without a simulation
+template <typename CostFunctor>
+void InstallFeasibilityChecker(eopt::BatchEvaluator<CostFunctor> & evaluator, CPtr<ILayoutView> layout)
+{
+    auto checker = std::make_shared<eopt::FeasibilityChecker>(layout);
+    for (size_t w = 0; w < evaluator.Workers(); ++w)
+        evaluator.Functor(w).SetFeasibilityChecker(checker);
 }
 
-struct StaticCostFunctor
+// with a checkpoint dir the state is saved atomically every checkpointInterval steps and a run
+// finding an unfinished checkpoint of the same run identity there continues exactly where it stopped
+template <typename CostFunctor>
+std::pair<std::vector<double>, double> SimulatedAnnealing(CPtr<ILayoutView> layout, double initialTemperature, double coolingRate, size_t maxIteration, size_t batchSize = 1, size_t seed = 0,
+                                                          std::shared_ptr<eopt::EvaluationCache> cache = nullptr, const std::string & checkpointDir = {}, size_t checkpointInterval = 10)
 {
-    inline static constexpr size_t PARR_NUM = 15;
-    explicit StaticCostFunctor(CPtr<ILayoutView> layout) : m_layout(layout)
-    {
-        m_compIdxMap = {
-            {0, "Inst1/M1"}, {1, "Inst2/M1"}, {2, "Inst3/M1"}, {3, "Inst1/M2"}, {4, "Inst2/M2"}, {5, "Inst3/M2"}
-        };
+    //each of the maxIteration steps scores a batch of neighbours concurrently, the best one goes through
+    //metropolis acceptance and the temperature cools once per step as with a single neighbour
+    eopt::BatchEvaluator<CostFunctor> evaluator(batchSize, generic::fs::CurrentPath(), layout);
+    InstallFeasibilityChecker(evaluator, layout);
+    for (size_t w = 0; w < evaluator.Workers(); ++w)
+        evaluator.Functor(w).SetCache(cache);
+    auto rng = MakeRandomEngine(seed);
+    std::uniform_real_distribution<double> uniform(0, 1);
+
+    eopt::AnnealingState state;
+    eopt::RunIdentity identity{CostFunctor::PARR_NUM, evaluator.Workers(), seed, maxIteration, initialTemperature, coolingRate};
+    std::unique_ptr<eopt::Checkpoint> checkpoint;
+    std::unique_ptr<eopt::HistoryLog> history;
+    if (not checkpointDir.empty()) checkpoint.reset(new eopt::Checkpoint(checkpointDir));
+    bool resume{false};
+    try { resume = checkpoint && checkpoint->Load(state, identity); }
+    catch (const std::invalid_argument & e) {
+        std::cout << e.what() << ", remove it or choose another checkpoint dir to start a new run" << std::endl;
+        return {{}, std::numeric_limits<double>::max()};
+    }
+    if (resume && state.complete) {
+        std::cout << "checkpoint holds a finished run, start a new one" << std::endl;
+        resume = false;
+    }
+    if (resume) {
+        state.LoadEngine(rng);
+        history.reset(new eopt::HistoryLog(checkpoint->HistoryFile(), 1024, state.historyOffset));
+        std::cout << "resume from iteration " << state.iteration << ", best: " << state.bestCost << std::endl;
+    }
+    else {
+        if (checkpoint) history.reset(new eopt::HistoryLog(checkpoint->HistoryFile()));
+        state = eopt::AnnealingState{};
+        state.identity = identity;
+        state.temperature = initialTemperature;
+        state.currentSolution = RandomSolution(CostFunctor::PARR_NUM, rng);
+        state.currentCost = evaluator.Evaluate({state.currentSolution}).front();
+        state.bestCost = state.currentCost;
+        state.bestSolution = state.currentSolution;
+        if (history) history->Append(state.currentSolution, state.currentCost);
     }
 
-    bool operator() (const double* const parameters, double* residual) const
-    {
-        std::cout << "test paras: ";
-        for (size_t i = 0; i < 12; ++i) {
-            std::cout << parameters[i] << ", ";
-        }
-        for (size_t i = 0; i < 12; ++i) {
-            if (parameters[i] < 0 || 1 < parameters[i]) return false;
+    size_t steps{0};
+    for (size_t i = state.iteration; i < maxIteration; ++i) {
+        std::vector<std::vector<double> > candidates;
+        for (size_t k = 0; k < evaluator.Workers(); ++k)
+            candidates.emplace_back(FeasibleNeighbour(evaluator.Functor(0), state.currentSolution, 1e-3, 1e-1, rng));
+        auto costs = evaluator.Evaluate(candidates);
+        auto index = std::distance(costs.begin(), std::min_element(costs.begin(), costs.end()));
+        auto newCost = costs.at(index);
+        if (history) {
+            for (size_t k = 0; k < candidates.size(); ++k)
+                history->Append(candidates[k], costs[k]);
         }
-        auto clone = m_layout->Clone();
-        const auto & coordUnits = m_layout->GetCoordUnits();
-        for (size_t i = 0; i < 3; ++i) {
-            auto comp = clone->FindComponentByName(m_compIdxMap.at(i));
-            ECAD_TRACE("comp: %1%", comp->GetName())
-            FVector2D shift(parameters[i * 2 + 0] * 10300, parameters[i * 2 + 1] * 4350);
-            auto transform = EDataMgr::Instance().CreateTransform2D(coordUnits, 1.0, 0.0, shift);
-            comp->AddTransform(transform);
+        
+        auto deltaCost = newCost - state.currentCost;
+        auto acceptanceProbability = exp(-deltaCost / state.temperature);
+
+        if (deltaCost < 0 || acceptanceProbability > uniform(rng)) {
+            state.currentSolution = candidates.at(index);
+            state.currentCost = newCost;
         }
 
-        for (size_t i = 3; i < 6; ++i) {
-            auto comp = clone->FindComponentByName(m_compIdxMap.at(i));
-            ECAD_TRACE("comp: %1%", comp->GetName())
-            FVector2D shift(parameters[i * 2 + 0] * 3250, parameters[i * 2 + 1] * 4200);
-            auto transform = EDataMgr::Instance().CreateTransform2D(coordUnits, 1.0, 0.0, shift);
-            comp->AddTransform(transform);
+        if (state.currentCost < state.bestCost) {
+            state.bestSolution = state.currentSolution;
+            state.bestCost = state.currentCost;
         }
 
-        EPrismaThermalModelExtractionSettings prismaSettings;
-        prismaSettings.workDir = generic::fs::CurrentPath();
-        prismaSettings.meshSettings.iteration = 1e5;
-        prismaSettings.meshSettings.minAlpha = 20;
-        prismaSettings.meshSettings.minLen = 1e-2;
-        prismaSettings.meshSettings.maxLen = 5000;
-
-        EThermalStaticSimulationSetup setup;
-        setup.environmentTemperature = 25;
-        setup.workDir = prismaSettings.workDir;
-        residual[0] = clone->RunThermalSimulation(prismaSettings, setup).second;
-        std::cout << "maxT: " << residual[0] << std::endl;
-        return true;
+        state.temperature *= coolingRate;
+        state.iteration = i + 1;
+        state.complete = state.iteration >= maxIteration;
+        if (checkpoint && (0 == ++steps % checkpointInterval || state.complete)) {
+            state.historyOffset = history->Flush();
+            state.SaveEngine(rng);
+            if (not checkpoint->Save(state))
+                std::cout << "failed to save checkpoint at iteration " << state.iteration << " to " << checkpoint->StateFile() << std::endl;
+        }
     }
-private:
-    CPtr<ILayoutView> m_layout;
-    std::unordered_map<size_t, std::string> m_compIdxMap;
-};
 
-struct TransientCostFunctor
+    return {state.bestSolution, state.bestCost};
+}
+
+// replica exchange: chains run at fixed temperatures on separate workers and
+// periodically swap states between neighbouring temperatures
+template <typename CostFunctor>
+std::pair<std::vector<double>, double> ParallelTempering(CPtr<ILayoutView> layout, double minTemperature, double maxTemperature, size_t chains, size_t maxIteration, size_t swapInterval = 10, size_t seed = 0)
 {
-    inline static constexpr size_t PARR_NUM = 3;
-    explicit TransientCostFunctor(CPtr<ILayoutView> layout) : m_layout(layout)
-    {
-        m_compIdxMap = {
-            {0, "Inst1/M1"}, {1, "Inst2/M1"}, {2, "Inst3/M1"}, {3, "Inst1/M2"}, {4, "Inst2/M2"}, {5, "Inst3/M2"}
-        };
-        // m_lyrParaIdxMap = { {"TopCu", 12}, {"Substrate", 13}, {"CuPlate", 14}}
-        m_lyrParaIdxMap = { {"TopCu", 0}, {"Substrate", 1}, {"CuPlate", 2} }; 
+    GENERIC_ASSERT(chains > 1 && minTemperature < maxTemperature)
+    eopt::BatchEvaluator<CostFunctor> evaluator(chains, generic::fs::CurrentPath(), layout);
+    InstallFeasibilityChecker(evaluator, layout);
+    std::uniform_real_distribution<double> uniform(0, 1);
+
+    std::vector<double> temperatures(chains);
+    auto ratio = std::pow(maxTemperature / minTemperature, 1.0 / (chains - 1));
+    for (size_t c = 0; c < chains; ++c)
+        temperatures[c] = minTemperature * std::pow(ratio, c);
+
+    std::vector<RandomEngine> rngs;
+    std::vector<std::vector<double> > solutions;
+    for (size_t c = 0; c < chains; ++c) {
+        rngs.emplace_back(MakeRandomEngine(seed, c + 1));
+        solutions.emplace_back(RandomSolution(CostFunctor::PARR_NUM, rngs.back()));
     }
+    auto swapRng = MakeRandomEngine(seed, 0);
+    auto costs = evaluator.Evaluate(solutions);
 
-    bool operator() (const double* const parameters, double* residual) const
-    {
-        std::cout << "test paras: ";
-        for (size_t i = 0; i < PARR_NUM; ++i) {
-            std::cout << parameters[i] << ", ";
-            if (parameters[i] < 0 || 1 < parameters[i]) return false;
-        }
-        std::cout << std::endl;
-
-        auto clone = m_layout->Clone();
-        for (const auto & [lyrName, index] : m_lyrParaIdxMap) {
-            auto layer = clone->FindLayerByName(lyrName); { ECAD_ASSERT(layer) }
-            auto stackupLayer = layer->GetStackupLayerFromLayer(); { ECAD_ASSERT(layer) }
-            clone->ModifyStackupLayerThickness(lyrName, stackupLayer->GetThickness() + parameters[index] * 1000);
-            std::cout << "layer " << lyrName << " 's thickness: " << stackupLayer->GetThickness() << std::endl;
+    auto best = std::distance(costs.begin(), std::min_element(costs.begin(), costs.end()));
+    auto bestCost = costs.at(best);
+    auto bestSolution = solutions.at(best);
+    for (size_t i = 0; i < maxIteration; ++i) {
+        std::vector<std::vector<double> > candidates(chains);
+        for (size_t c = 0; c < chains; ++c)
+            candidates[c] = FeasibleNeighbour(evaluator.Functor(0), solutions[c], 1e-3, 1e-1, rngs[c]);
+        auto newCosts = evaluator.Evaluate(candidates);
+
+        for (size_t c = 0; c < chains; ++c) {
+            auto deltaCost = newCosts[c] - costs[c];
+            if (deltaCost < 0 || std::exp(-deltaCost / temperatures[c]) > uniform(rngs[c])) {
+                solutions[c] = std::move(candidates[c]);
+                costs[c] = newCosts[c];
+            }
+            if (costs[c] < bestCost) {
+                bestSolution = solutions[c];
+                bestCost = costs[c];
+            }
         }
-        
-        EPrismaThermalModelExtractionSettings prismaSettings;
-        prismaSettings.workDir = generic::fs::CurrentPath();
-        prismaSettings.meshSettings.iteration = 1e5;
-        prismaSettings.meshSettings.minAlpha = 20;
-        prismaSettings.meshSettings.minLen = 1e-2;
-        prismaSettings.meshSettings.maxLen = 5000;
-
-        EThermalTransientSimulationSetup setup;
-        setup.workDir = prismaSettings.workDir + ECAD_SEPS + std::to_string(parameters[1] * 100);
-        setup.environmentTemperature = 25;
-        setup.settings.mor = false;
-        setup.settings.adaptive = true;
-        setup.settings.dumpRawData = true;
-        setup.settings.duration = 1;
-        setup.settings.step = 0.01;
-        setup.settings.samplingWindow = 0.1;
-        setup.settings.minSamplingInterval = 0.0005;
-        setup.settings.absoluteError = 1e-1;
-        setup.settings.relativeError = 1e-1;
-        EThermalTransientExcitation excitation = [](EFloat t){ return std::abs(std::sin(generic::math::pi * t / 0.05)); };
-        setup.settings.excitation = &excitation;
-        auto [minT, maxT] = clone->RunThermalSimulation(prismaSettings, setup);
-        residual[0] = maxT - minT;
-        std::cout << "minT: " << minT << ", maxT: " << maxT << ", dT: " << maxT - minT << std::endl;
-        return true;
-    }
-private:
-    CPtr<ILayoutView> m_layout;
-    std::unordered_map<size_t, std::string> m_compIdxMap;
-    std::unordered_map<std::string, size_t> m_lyrParaIdxMap;
-};
 
-std::vector<double> RandomSolution(size_t paraNums)
-{
-    std::vector<double> solution(paraNums);
-    for (auto & value : solution)
-        value = generic::math::Random<double>(0.1, 0.9);
-    return solution;
-}
-
-std::vector<double> RandomNeighbour(const std::vector<double> & original, double minStep, double maxStep)
-{
-    GENERIC_ASSERT(minStep < maxStep)
-    std::vector<double> solution(original.size());
-    for (size_t i = 0; i < solution.size(); ++i) {
-        do {
-            auto step = generic::math::Random(minStep, maxStep);
-            step *= generic::math::Random<double>(0, 1) > 0.5 ? 1 : -1;
-            solution[i] = original.at(i) + step;
-        } while (solution[i] < 0.1 || 0.9 < solution[i]);
+        if ((i + 1) % swapInterval) continue;
+        for (size_t c = (i / swapInterval) % 2; c + 1 < chains; c += 2) {
+            auto exponent = (1 / temperatures[c] - 1 / temperatures[c + 1]) * (costs[c] - costs[c + 1]);
+            if (exponent >= 0 || std::exp(exponent) > uniform(swapRng)) {
+                std::swap(solutions[c], solutions[c + 1]);
+                std::swap(costs[c], costs[c + 1]);
+            }
+        }
     }
-    return solution;
+    return {bestSolution, bestCost};
 }
 
+// screens neighbours on the coarse fidelity while the temperature is high, only candidates whose corrected
+// coarse cost is below current + screenMargin * T are promoted to a fine solve and the single metropolis
+// decision is taken on the fine cost; after screenIteration steps it runs on fine only
 template <typename CostFunctor>
-std::pair<std::vector<double>, double> SimulatedAnnealing(CPtr<ILayoutView> layout, double initialTemperature, double coolingRate, size_t maxIteration)
+std::pair<std::vector<double>, double> MultiFidelityAnnealing(CPtr<ILayoutView> layout, double initialTemperature, double coolingRate, size_t maxIteration, size_t screenIteration,
+                                                              size_t batchSize = 1, size_t promote = 1, size_t seed = 0, double screenMargin = 1)
 {
-    auto currentSolution = RandomSolution(CostFunctor::PARR_NUM);
-    double currentCost{0};
-    CostFunctor costFunctor(layout);
-    costFunctor(currentSolution.data(), &currentCost);
+    eopt::BatchEvaluator<CostFunctor> evaluator(batchSize, generic::fs::CurrentPath(), layout);
+    InstallFeasibilityChecker(evaluator, layout);
+    auto setFidelity = [&](eopt::Fidelity fidelity) {
+        for (size_t w = 0; w < evaluator.Workers(); ++w)
+            evaluator.Functor(w).SetFidelity(fidelity);
+    };
+    eopt::FidelityCorrection correction;
+    auto rng = MakeRandomEngine(seed);
+    std::uniform_real_distribution<double> uniform(0, 1);
+    auto accept = [&](double deltaCost) { return deltaCost < 0 || std::exp(-deltaCost / initialTemperature) > uniform(rng); };
+
+    auto currentSolution = RandomSolution(CostFunctor::PARR_NUM, rng);
+    setFidelity(eopt::Fidelity::Fine);
+    double currentCost = evaluator.Evaluate({currentSolution}).front();
     auto bestCost = currentCost;
     auto bestSolution = currentSolution;
+    size_t fineSolves{1}, coarseSolves{0};
     for (size_t i = 0; i < maxIteration; ++i) {
-        auto newSolution = RandomNeighbour(currentSolution, 1e-3, 1e-1);
-        double newCost;
-        CostFunctor costFunctor(layout);
-        costFunctor(newSolution.data(), &newCost);
-        
-        auto deltaCost = newCost - currentCost;
-        auto acceptanceProbability = exp(-deltaCost / initialTemperature);
+        std::vector<std::vector<double> > candidates;
+        for (size_t k = 0; k < evaluator.Workers(); ++k)
+            candidates.emplace_back(FeasibleNeighbour(evaluator.Functor(0), currentSolution, 1e-3, 1e-1, rng));
+
+        std::vector<double> costs;
+        if (i < screenIteration) {
+            setFidelity(eopt::Fidelity::Coarse);
+            auto coarse = evaluator.Evaluate(candidates);
+            coarseSolves += candidates.size();
+            std::vector<size_t> order(candidates.size());
+            std::iota(order.begin(), order.end(), 0);
+            std::sort(order.begin(), order.end(), [&](size_t a, size_t b){ return coarse[a] < coarse[b]; });
+
+            std::vector<size_t> promoted;
+            for (size_t k = 0; k < std::min(promote, order.size()); ++k) {
+                if (coarse[order[k]] == std::numeric_limits<double>::max()) break;
+                if (correction(coarse[order[k]]) < currentCost + screenMargin * initialTemperature) promoted.emplace_back(order[k]);
+            }
+            if (promoted.empty()) {
+                initialTemperature *= coolingRate;
+                continue;
+            }
+
+            std::vector<std::vector<double> > promotedCandidates;
+            for (auto index : promoted) promotedCandidates.emplace_back(candidates.at(index));
+            setFidelity(eopt::Fidelity::Fine);
+            costs = evaluator.Evaluate(promotedCandidates);
+            fineSolves += promotedCandidates.size();
+            for (size_t k = 0; k < promoted.size(); ++k)
+                if (costs[k] != std::numeric_limits<double>::max()) correction.Add(coarse[promoted[k]], costs[k]);
+            candidates = std::move(promotedCandidates);
+        }
+        else {
+            setFidelity(eopt::Fidelity::Fine);
+            costs = evaluator.Evaluate(candidates);
+            fineSolves += candidates.size();
+        }
 
-        if (deltaCost < 0 || acceptanceProbability > generic::math::Random<double>(0, 1) / 1.0) {
-            currentSolution = newSolution;
-            currentCost = newCost;
+        auto index = std::distance(costs.begin(), std::min_element(costs.begin(), costs.end()));
+        if (accept(costs.at(index) - currentCost)) {
+            currentSolution = candidates.at(index);
+            currentCost = costs.at(index);
         }
 
         if (currentCost < bestCost) {
@@ -423,14 +304,101 @@ std::pair<std::vector<double>, double> SimulatedAnnealing(CPtr<ILayoutView> layo
 
         initialTemperature *= coolingRate;
     }
-
+    std::cout << "coarse solves: " << coarseSolves << ", fine solves: " << fineSolves << ", correction samples: " << correction.Samples() << std::endl;
     return {bestSolution, bestCost};
 }
 
+// seeds a gaussian process with a latin hypercube batch, then only simulates the batches
+// chosen by expected improvement on the surrogate, both only span the parameters the cost depends on.
+// infeasible points are not simulated, they join the training set at the worst cost seen so far so
+// the surrogate learns to avoid them, and stop the search once maxEvaluation of them were proposed
+template <typename CostFunctor>
+std::pair<std::vector<double>, double> SurrogateOptimization(CPtr<ILayoutView> layout, size_t initialSamples, size_t maxEvaluation, size_t batchSize = 1, size_t seed = 0)
+{
+    eopt::BatchEvaluator<CostFunctor> evaluator(batchSize, generic::fs::CurrentPath(), layout);
+    InstallFeasibilityChecker(evaluator, layout);
+    auto rng = MakeRandomEngine(seed);
+    std::vector<std::vector<double> > points, infeasible;
+    std::vector<double> costs;
+    auto evaluate = [&](const std::vector<std::vector<double> > & candidates) {
+        std::vector<std::vector<double> > feasible;
+        for (const auto & candidate : candidates)
+            (evaluator.Functor(0).Feasible(candidate.data()) ? feasible : infeasible).emplace_back(candidate);
+        auto results = evaluator.Evaluate(feasible);
+        for (size_t i = 0; i < feasible.size(); ++i) {
+            if (results[i] == std::numeric_limits<double>::max()) continue;
+            points.emplace_back(feasible[i]);
+            costs.emplace_back(results[i]);
+        }
+        return feasible.size();
+    };
+    auto trainingSet = [&] {
+        auto x = points;
+        auto y = costs;
+        auto worst = *std::max_element(costs.begin(), costs.end());
+        x.insert(x.end(), infeasible.begin(), infeasible.end());
+        y.resize(x.size(), worst);
+        return std::make_pair(std::move(x), std::move(y));
+    };
+
+    auto evaluations = evaluate(eopt::LatinHypercube(initialSamples, CostFunctor::ACTIVE_PARR_NUM, 0.1, 0.9, rng));
+    while (evaluations < maxEvaluation && infeasible.size() < maxEvaluation && not points.empty()) {
+        auto batch = std::min(evaluator.Workers(), maxEvaluation - evaluations);
+        auto [x, y] = trainingSet();
+        auto proposals = eopt::ProposeBatch(std::move(x), std::move(y), batch, 0.1, 0.9, rng);
+        if (proposals.empty()) break;//surrogate could not be fitted
+        evaluations += evaluate(proposals);
+        std::cout << "evaluations: " << evaluations << ", infeasible: " << infeasible.size() << ", best: " << *std::min_element(costs.begin(), costs.end()) << std::endl;
+    }
+    if (points.empty()) return {{}, std::numeric_limits<double>::max()};
+    auto best = std::distance(costs.begin(), std::min_element(costs.begin(), costs.end()));
+    return {points.at(best), costs.at(best)};
+}
+
 void testStatic(CPtr<ILayoutView> layout)
 {
-    auto [bestSolution, bestCost] = SimulatedAnnealing<StaticCostFunctor>(layout, 100, 0.95, 1e3);
+    auto cache = std::make_shared<eopt::EvaluationCache>(1, 1, generic::fs::CurrentPath() + ECAD_SEPS + "static.cache", SimulationIdentity());
+    //fixed batch size, it is part of the checkpoint identity and a resumed job may land on a node with another core count
+    auto [bestSolution, bestCost] = SimulatedAnnealing<StaticCostFunctor>(layout, 100, 0.95, 1e3, 16, 0, cache,
+                                                                       generic::fs::CurrentPath() + ECAD_SEPS + "static.ckpt");
     std::cout << "solution: " << generic::fmt::Fmt2Str(bestSolution, ",") << ", maxT: " << bestCost << std::endl;
+    std::cout << "cache hits: " << cache->Hits() << ", misses: " << cache->Misses() << std::endl;
+}
+
+void testStaticTempering(CPtr<ILayoutView> layout)
+{
+    auto chains = std::max<size_t>(2, std::thread::hardware_concurrency());
+    auto [bestSolution, bestCost] = ParallelTempering<StaticCostFunctor>(layout, 1, 100, chains, 1e3 / chains);
+    std::cout << "solution: " << generic::fmt::Fmt2Str(bestSolution, ",") << ", maxT: " << bestCost << std::endl;
+}
+
+void testStaticMultiFidelity(CPtr<ILayoutView> layout)
+{
+    auto [bestSolution, bestCost] = MultiFidelityAnnealing<StaticCostFunctor>(layout, 100, 0.95, 1e3, 5e2, std::thread::hardware_concurrency(), 2);
+    std::cout << "solution: " << generic::fmt::Fmt2Str(bestSolution, ",") << ", maxT: " << bestCost << std::endl;
+}
+
+void testStaticSurrogate(CPtr<ILayoutView> layout)
+{
+    auto [bestSolution, bestCost] = SurrogateOptimization<StaticCostFunctor>(layout, 50, 200, std::thread::hardware_concurrency());
+    std::cout << "solution: " << generic::fmt::Fmt2Str(bestSolution, ",") << ", maxT: " << bestCost << std::endl;
+}
+
+void testStaticFarm(CPtr<ILayoutView> layout)
+{
+    //each worker process evaluates on its forked copy of the loaded design, hung simulations are killed after 10 min
+    auto checker = std::make_shared<eopt::FeasibilityChecker>(layout);
+    eopt::WorkerFarm<StaticCostFunctor> farm(std::thread::hardware_concurrency(), generic::fs::CurrentPath() + ECAD_SEPS + "farm",
+        [layout, checker](const std::string & workDir) {
+            auto functor = std::make_unique<StaticCostFunctor>(layout, workDir);
+            functor->SetFeasibilityChecker(checker);
+            return functor;
+        }, 600);
+    auto rng = MakeRandomEngine(0);
+    auto samples = eopt::LatinHypercube(4 * farm.Workers(), StaticCostFunctor::ACTIVE_PARR_NUM, 0.1, 0.9, rng);
+    auto costs = farm.Evaluate(samples);
+    auto best = std::distance(costs.begin(), std::min_element(costs.begin(), costs.end()));
+    std::cout << "solution: " << generic::fmt::Fmt2Str(samples.at(best), ",") << ", maxT: " << costs.at(best) << ", restarts: " << farm.Restarts() << std::endl;
 }
 
 #ifdef ECAD_CERES_SOLVER_SUPPORT
@@ -440,7 +408,8 @@ void testStaticCeres(CPtr<ILayoutView> layout)
     std::vector<double> parameters(12, 0.2);
 
     ceres::Problem problem;
-    auto costFunc = new ceres::NumericDiffCostFunction<CostFunctor, ceres::FORWARD, 1, 12>(new CostFunctor(layout));
+    //no evaluation cache, a 1e-3 step moves a die by a few um which is close to the cache resolution
+    auto costFunc = new eopt::ParallelDiffCostFunction<StaticCostFunctor, 12>(1e-3, 13, generic::fs::CurrentPath(), layout);
     problem.AddResidualBlock(costFunc, new ceres::CauchyLoss(0.5), parameters.data());
     // problem.AddResidualBlock(costFunc, nullptr, parameters.data());
 
@@ -456,7 +425,7 @@ void testStaticCeres(CPtr<ILayoutView> layout)
 	options.linear_solver_type = ceres::DENSE_QR;
 	// options.trust_region_strategy_type = ceres::DOGLEG;
 	options.logging_type = ceres::SILENT;
-    options.check_gradients = true;
+    options.check_gradients = false;
     options.gradient_check_numeric_derivative_relative_step_size = 1e-3;
     // options.min_line_search_step_size = 1e-1;
     // options.min_trust_region_radius = 1e-2;
@@ -470,22 +439,58 @@ void testStaticCeres(CPtr<ILayoutView> layout)
 }
 #endif//ECAD_CERES_SOLVER_SUPPORT
 
+void testStaticSweep(CPtr<ILayoutView> layout)
+{
+    //space filling design over the die placements, infeasible points are reported as failed rows
+    auto paras = eopt::Sobol(64, StaticCostFunctor::ACTIVE_PARR_NUM);
+    for (auto & point : paras)
+        for (auto & value : point) value = 0.1 + 0.8 * value;
+    std::vector<std::string> names;
+    for (auto comp : {"Inst1/M1", "Inst2/M1", "Inst3/M1", "Inst1/M2", "Inst2/M2", "Inst3/M2"}) {
+        names.emplace_back(std::string(comp) + ".x");
+        names.emplace_back(std::string(comp) + ".y");
+    }
+
+    auto checker = std::make_shared<eopt::FeasibilityChecker>(layout);
+    eopt::SweepRunner<StaticCostFunctor> runner(generic::fs::CurrentPath() + ECAD_SEPS + "static.sweep");
+    auto table = runner.Run(paras, names, [&](StaticCostFunctor & functor) { functor.SetFeasibilityChecker(checker); }, layout);
+    std::cout << "jobs: " << runner.Schedule().jobs << " x threads: " << runner.Schedule().innerThreads
+              << ", memory per job: " << runner.MemoryPerJob() / 1024 / 1024 << "MB" << std::endl;
+    table.WriteCsv(generic::fs::CurrentPath() + ECAD_SEPS + "static.sweep.csv");
+}
+
 void testTrans(CPtr<ILayoutView> layout)
 {  
     // auto [bestSolution, bestCost] = SimulatedAnnealing<TransientCostFunctor>(layout, 100, 0.95, 1e3);
     // std::cout << "solution: " << generic::fmt::Fmt2Str(bestSolution, ",") << ", maxT: " << bestCost << std::endl;
 
-    std::vector<TransientCostFunctor> costFunctors(10, TransientCostFunctor(layout));
-    std::vector<std::vector<double> > paras;
-    for (size_t i = 0; i < 10; ++i)
-        paras.emplace_back(std::vector<double>{0.0, 0.1 * i, 0.0, 0.0});
-
-    generic::thread::ThreadPool pool;
-    for (size_t i = 0; i < 10; ++i) {
-        pool.Submit([&]{
-            costFunctors.at(i)(paras.at(i).data(), &paras.at(i).back());
-        });
-    }
+    //substrate thickness levels, the other layers stay at their base thickness
+    std::vector<double> levels;
+    for (size_t i = 0; i < 10; ++i) levels.emplace_back(0.1 * i);
+    auto paras = eopt::FullFactorial({{0.0}, levels, {0.0}});
+
+    //integrate only as many excitation periods as the ripple needs to settle, calibrated on the thickest
+    //substrate which has the longest thermal time constant of the sweep
+    TransientCostFunctor calibrator(layout);
+    calibrator.SetResultSink(std::make_shared<eopt::MemoryResultSink>());
+    auto slowest = std::max_element(paras.begin(), paras.end(), [](const auto & a, const auto & b) { return a.at(1) < b.at(1); });
+    auto calibration = calibrator.CalibrateSettleCycles(slowest->data(), 1e-2);
+    auto settleCycles = calibration.cycles;
+    std::cout << "settle cycles: " << settleCycles << ", calibration: " << calibration.runs << " runs, "
+              << calibration.periods << " periods, " << calibration.seconds << "s" << std::endl;
+
+    //keep the sweep I/O free, only the reductions are kept
+    auto sink = std::make_shared<eopt::MemoryResultSink>();
+    eopt::SweepRunner<TransientCostFunctor> runner(generic::fs::CurrentPath() + ECAD_SEPS + "sweep");
+    auto table = runner.Run(paras, {"TopCu", "Substrate", "CuPlate"}, [&](TransientCostFunctor & functor) {
+        functor.SetResultSink(sink);
+        functor.SetPeriodicExcitation(0.05, settleCycles);
+    }, layout);
+    std::cout << "jobs: " << runner.Schedule().jobs << " x threads: " << runner.Schedule().innerThreads
+              << ", memory per job: " << runner.MemoryPerJob() / 1024 / 1024 << "MB" << std::endl;
+    for (size_t i = 0; i < table.Rows(); ++i)
+        std::cout << "paras: " << generic::fmt::Fmt2Str(paras.at(i), ",") << ", dT: " << table.Costs().at(i) << std::endl;
+    table.WriteCsv(generic::fs::CurrentPath() + ECAD_SEPS + "sweep.csv");
 }
 
 int main(int argc, char * argv[])
@@ -493,10 +498,15 @@ int main(int argc, char * argv[])
     ::signal(SIGSEGV, &SignalHandler);
     ::signal(SIGABRT, &SignalHandler);
 
-    EDataMgr::Instance().Init(ELogLevel::Trace);
+    EDataMgr::Instance().Init(ELogLevel::Info);
 
-    auto layout = SetupDesign();
+    auto layout = LoadOrSetupDesign(generic::fs::CurrentPath());
     // testStatic(layout);
+    // testStaticTempering(layout);
+    // testStaticMultiFidelity(layout);
+    // testStaticSurrogate(layout);
+    // testStaticFarm(layout);
+    // testStaticSweep(layout);
     testTrans(layout);
 
 #ifdef ECAD_CERES_SOLVER_SUPPORT